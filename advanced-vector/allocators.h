@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// Результат allocate_at_least: блок памяти и число элементов, которое в нём помещается
+template <typename T>
+struct AllocationResult {
+    T* ptr;
+    size_t count;
+};
+
+// Аллокатор поверх malloc/free. Умеет перевыделять блок через realloc, поэтому
+// Vector с тривиально перемещаемыми элементами растёт без копирования: большие блоки
+// glibc переносит при помощи mremap, не трогая страницы с данными
+template <typename T>
+class MallocAllocator {
+public:
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "malloc не гарантирует выравнивание сверх alignof(std::max_align_t)");
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    MallocAllocator() noexcept = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(CheckAllocated(std::malloc(ByteCount(n))));
+    }
+
+    // Выделяет память не менее чем под n элементов. Под glibc сообщает весь
+    // фактический размер блока, включая запас до ближайшего размерного класса malloc
+    AllocationResult<T> allocate_at_least(size_t n) {
+        T* p = allocate(n);
+#if defined(__GLIBC__)
+        return {p, std::max(n, malloc_usable_size(p) / sizeof(T))};
+#else
+        return {p, n};
+#endif
+    }
+
+    void deallocate(T* p, size_t /*n*/) noexcept {
+        std::free(p);
+    }
+
+    // Перевыделяет блок под new_n элементов с сохранением содержимого.
+    // При ошибке выбрасывает std::bad_alloc, исходный блок остаётся нетронутым
+    T* reallocate(T* p, size_t /*old_n*/, size_t new_n) {
+        return static_cast<T*>(CheckAllocated(std::realloc(p, ByteCount(new_n))));
+    }
+
+    template <typename U>
+    bool operator==(const MallocAllocator<U>& /*other*/) const noexcept {
+        return true;
+    }
+
+private:
+    static size_t ByteCount(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return n * sizeof(T);
+    }
+
+    static void* CheckAllocated(void* p) {
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+};
+
+// Аллокатор, выравнивающий буфер по ALIGN байтам (но не слабее alignof(T)): например,
+// по размеру кэш-линии, чтобы соседние векторы не делили линии, а загрузки SIMD не
+// пересекали их границ. Буферы от PAGE_ALIGN_FROM байтов выравниваются по странице
+template <typename T, size_t ALIGN = 64, size_t PAGE_ALIGN_FROM = (size_t{64} << 10)>
+class AlignedAllocator {
+public:
+    static_assert((ALIGN & (ALIGN - 1)) == 0, "Выравнивание должно быть степенью двойки");
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    static constexpr size_t PAGE_SIZE = 4096;
+    // Выравнивание, которое гарантирует любой буфер этого аллокатора
+    static constexpr size_t alignment = std::max(ALIGN, alignof(T));
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, ALIGN, PAGE_ALIGN_FROM>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, ALIGN, PAGE_ALIGN_FROM>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), BufferAlignment(n)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        ::operator delete(p, n * sizeof(T), BufferAlignment(n));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, ALIGN, PAGE_ALIGN_FROM>& /*other*/) const noexcept {
+        return true;
+    }
+
+private:
+    // Выравнивание зависит только от размера, поэтому deallocate получает то же, что allocate
+    static std::align_val_t BufferAlignment(size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        return std::align_val_t{bytes >= PAGE_ALIGN_FROM ? std::max(alignment, PAGE_SIZE) : alignment};
+    }
+};
@@ -0,0 +1,365 @@
+#include "vector.h"
+#include "vector_algorithms.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+#include <string>
+#include <vector>
+
+// Сравнение Vector и std::vector. Кроме времени на операцию каждый бенчмарк сообщает,
+// сколько байтов и выделений памяти приходится на одну операцию.
+// Сборка: g++ -std=c++20 -O2 -DNDEBUG benchmark.cpp -lbenchmark -lpthread -o benchmark
+
+namespace {
+
+    // Счётчики глобального operator new
+    size_t num_allocations = 0;
+    size_t num_allocated_bytes = 0;
+
+}  // namespace
+
+void* operator new(size_t size) {
+    ++num_allocations;
+    num_allocated_bytes += size;
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// Не встраивается, иначе GCC видит пару operator new/free и предупреждает о несоответствии
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, size_t /*size*/) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+    // Тривиально копируемая запись размером в кэш-линию
+    struct Pod64 {
+        uint64_t words[8];
+    };
+
+    // Копирование Pod64 в замерах ниже должно идти через memcpy
+    static_assert(Vector<Pod64>::BITWISE_COPY && Vector<Pod64>::TRIVIAL_DESTROY);
+    static_assert(!Vector<std::string>::BITWISE_COPY && !Vector<std::string>::TRIVIAL_DESTROY);
+
+    // Перемещение может выбросить исключение, поэтому при реаллокации элементы копируются
+    struct ThrowingMove {
+        explicit ThrowingMove(std::string value)
+        : value(std::move(value))  //
+        {
+        }
+        ThrowingMove(const ThrowingMove&) = default;
+        ThrowingMove& operator=(const ThrowingMove&) = default;
+        ThrowingMove(ThrowingMove&& other) noexcept(false)
+        : value(std::move(other.value))  //
+        {
+        }
+        ThrowingMove& operator=(ThrowingMove&& other) noexcept(false) {
+            value = std::move(other.value);
+            return *this;
+        }
+
+        std::string value;
+    };
+
+    template <typename T>
+    T MakeValue(size_t i);
+
+    template <>
+    Pod64 MakeValue<Pod64>(size_t i) {
+        return Pod64{{i, i, i, i, i, i, i, i}};
+    }
+
+    template <>
+    std::string MakeValue<std::string>(size_t i) {
+        // Строка длиннее буфера для коротких строк, чтобы её копирование выделяло память
+        return std::string(32, static_cast<char>('a' + i % 26));
+    }
+
+    template <>
+    ThrowingMove MakeValue<ThrowingMove>(size_t i) {
+        return ThrowingMove(MakeValue<std::string>(i));
+    }
+
+    // Единый интерфейс к сравниваемым контейнерам
+    template <typename T>
+    struct VectorApi {
+        using Value = T;
+        using Container = Vector<T>;
+
+        static void PushBack(Container& c, const T& value) {
+            c.PushBack(value);
+        }
+        static void EmplaceBack(Container& c, size_t i) {
+            c.EmplaceBack(MakeValue<T>(i));
+        }
+        static void Reserve(Container& c, size_t n) {
+            c.Reserve(n);
+        }
+        static void ShrinkToFit(Container& c) {
+            c.ShrinkToFit();
+        }
+        static void Insert(Container& c, size_t index, const T& value) {
+            c.Insert(c.cbegin() + index, value);
+        }
+        static void Erase(Container& c, size_t index) {
+            c.Erase(c.cbegin() + index);
+        }
+    };
+
+    template <typename T>
+    struct StdVectorApi {
+        using Value = T;
+        using Container = std::vector<T>;
+
+        static void PushBack(Container& c, const T& value) {
+            c.push_back(value);
+        }
+        static void EmplaceBack(Container& c, size_t i) {
+            c.emplace_back(MakeValue<T>(i));
+        }
+        static void Reserve(Container& c, size_t n) {
+            c.reserve(n);
+        }
+        static void ShrinkToFit(Container& c) {
+            c.shrink_to_fit();
+        }
+        static void Insert(Container& c, size_t index, const T& value) {
+            c.insert(c.cbegin() + index, value);
+        }
+        static void Erase(Container& c, size_t index) {
+            c.erase(c.cbegin() + index);
+        }
+    };
+
+    template <typename Api>
+    typename Api::Container MakeContainer(size_t size) {
+        typename Api::Container c;
+        for (size_t i = 0; i < size; ++i) {
+            Api::PushBack(c, MakeValue<typename Api::Value>(i));
+        }
+        return c;
+    }
+
+    // Измеряет выделения памяти внутри цикла бенчмарка и публикует счётчики
+    // в пересчёте на одну операцию
+    class AllocationScope {
+    public:
+        explicit AllocationScope(benchmark::State& state)
+        : state_(state)
+        , allocations_(num_allocations)
+        , bytes_(num_allocated_bytes) {
+        }
+
+        ~AllocationScope() {
+            const double ops = static_cast<double>(state_.iterations()) * ops_per_iteration_;
+            if (ops == 0) {
+                return;
+            }
+            state_.counters["allocs/op"] = static_cast<double>(num_allocations - allocations_) / ops;
+            state_.counters["bytes/op"] = static_cast<double>(num_allocated_bytes - bytes_) / ops;
+            state_.counters["time/op"] = benchmark::Counter(
+                ops_per_iteration_, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+        }
+
+        void SetOpsPerIteration(size_t ops) {
+            ops_per_iteration_ = static_cast<double>(ops);
+        }
+
+    private:
+        benchmark::State& state_;
+        size_t allocations_;
+        size_t bytes_;
+        double ops_per_iteration_ = 1;
+    };
+
+    template <typename Api>
+    void BM_PushBack(benchmark::State& state) {
+        const size_t size = state.range(0);
+        const auto value = MakeValue<typename Api::Value>(0);
+        AllocationScope scope(state);
+        scope.SetOpsPerIteration(size);
+        for (auto _ : state) {
+            typename Api::Container c;
+            for (size_t i = 0; i < size; ++i) {
+                Api::PushBack(c, value);
+            }
+            benchmark::DoNotOptimize(c);
+        }
+    }
+
+    template <typename Api>
+    void BM_EmplaceBack(benchmark::State& state) {
+        const size_t size = state.range(0);
+        AllocationScope scope(state);
+        scope.SetOpsPerIteration(size);
+        for (auto _ : state) {
+            typename Api::Container c;
+            for (size_t i = 0; i < size; ++i) {
+                Api::EmplaceBack(c, i);
+            }
+            benchmark::DoNotOptimize(c);
+        }
+    }
+
+    template <typename Api>
+    void BM_ReserveThenPushBack(benchmark::State& state) {
+        const size_t size = state.range(0);
+        const auto value = MakeValue<typename Api::Value>(0);
+        AllocationScope scope(state);
+        scope.SetOpsPerIteration(size);
+        for (auto _ : state) {
+            typename Api::Container c;
+            Api::Reserve(c, size);
+            for (size_t i = 0; i < size; ++i) {
+                Api::PushBack(c, value);
+            }
+            benchmark::DoNotOptimize(c);
+        }
+    }
+
+    // Реаллокация заполненного вектора: перенос всех элементов в новый буфер и обратно
+    template <typename Api>
+    void BM_ReallocateFull(benchmark::State& state) {
+        const size_t size = state.range(0);
+        auto c = MakeContainer<Api>(size);
+        Api::ShrinkToFit(c);
+        AllocationScope scope(state);
+        scope.SetOpsPerIteration(2);
+        for (auto _ : state) {
+            Api::Reserve(c, size * 2);
+            Api::ShrinkToFit(c);
+            benchmark::DoNotOptimize(c);
+        }
+    }
+
+    template <typename Api>
+    void BM_InsertEraseMiddle(benchmark::State& state) {
+        const size_t size = state.range(0);
+        const auto value = MakeValue<typename Api::Value>(1);
+        auto c = MakeContainer<Api>(size);
+        Api::Reserve(c, size + 1);
+        AllocationScope scope(state);
+        scope.SetOpsPerIteration(2);
+        for (auto _ : state) {
+            Api::Insert(c, size / 2, value);
+            Api::Erase(c, size / 2);
+            benchmark::DoNotOptimize(c);
+        }
+    }
+
+    // Присваивание копии в вектор достаточной вместимости повторно использует его элементы
+    template <typename Api>
+    void BM_CopyAssignReuse(benchmark::State& state) {
+        const size_t size = state.range(0);
+        const auto src = MakeContainer<Api>(size);
+        auto dst = MakeContainer<Api>(size);
+        AllocationScope scope(state);
+        for (auto _ : state) {
+            dst = src;
+            benchmark::DoNotOptimize(dst);
+        }
+    }
+
+    template <typename Api>
+    void BM_Move(benchmark::State& state) {
+        const size_t size = state.range(0);
+        auto c = MakeContainer<Api>(size);
+        AllocationScope scope(state);
+        scope.SetOpsPerIteration(2);
+        for (auto _ : state) {
+            auto moved(std::move(c));
+            benchmark::DoNotOptimize(moved);
+            c = std::move(moved);
+        }
+    }
+
+    // Поиск отсутствующего значения: просмотр всего диапазона
+    template <typename T, bool SIMD>
+    void BM_Find(benchmark::State& state) {
+        const Vector<T> v(state.range(0));
+        for (auto _ : state) {
+            if constexpr (SIMD) {
+                benchmark::DoNotOptimize(Find(v, T{1}));
+            } else {
+                benchmark::DoNotOptimize(std::find(v.begin(), v.end(), T{1}));
+            }
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(T));
+    }
+
+    template <typename T, bool SIMD>
+    void BM_Sum(benchmark::State& state) {
+        const Vector<T> v(state.range(0));
+        for (auto _ : state) {
+            if constexpr (SIMD) {
+                benchmark::DoNotOptimize(Sum(v));
+            } else {
+                benchmark::DoNotOptimize(std::accumulate(v.begin(), v.end(), detail::simd::SumType<T>{}));
+            }
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0) * sizeof(T));
+    }
+
+    // Хеш и сравнение байтовых ключей
+    void BM_HashBytes(benchmark::State& state) {
+        Vector<uint8_t> key(state.range(0));
+        std::iota(key.begin(), key.end(), uint8_t{0});
+        const std::hash<Vector<uint8_t>> hasher;
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(hasher(key));
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+
+    void BM_CompareBytes(benchmark::State& state) {
+        const Vector<uint8_t> lhs(state.range(0));
+        const Vector<uint8_t> rhs(state.range(0));
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(lhs == rhs);
+            benchmark::DoNotOptimize(lhs <=> rhs);
+        }
+        state.SetBytesProcessed(state.iterations() * state.range(0) * 2);
+    }
+
+}  // namespace
+
+#define VECTOR_BENCHMARK(name, api, ...) \
+    BENCHMARK_TEMPLATE(name, api<Pod64>) __VA_ARGS__;        \
+    BENCHMARK_TEMPLATE(name, api<std::string>) __VA_ARGS__;  \
+    BENCHMARK_TEMPLATE(name, api<ThrowingMove>) __VA_ARGS__
+
+#define COMPARE_BENCHMARK(name, ...)                   \
+    VECTOR_BENCHMARK(name, VectorApi, __VA_ARGS__);    \
+    VECTOR_BENCHMARK(name, StdVectorApi, __VA_ARGS__)
+
+COMPARE_BENCHMARK(BM_PushBack, ->Arg(16)->Arg(1024)->Arg(65536));
+COMPARE_BENCHMARK(BM_EmplaceBack, ->Arg(16)->Arg(1024)->Arg(65536));
+COMPARE_BENCHMARK(BM_ReserveThenPushBack, ->Arg(16)->Arg(1024)->Arg(65536));
+COMPARE_BENCHMARK(BM_ReallocateFull, ->Arg(1024)->Arg(65536));
+COMPARE_BENCHMARK(BM_InsertEraseMiddle, ->Arg(1024)->Arg(65536));
+COMPARE_BENCHMARK(BM_CopyAssignReuse, ->Arg(16)->Arg(1024)->Arg(65536));
+COMPARE_BENCHMARK(BM_Move, ->Arg(1024));
+
+BENCHMARK_TEMPLATE(BM_Find, int32_t, true)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Find, int32_t, false)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Find, float, true)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Find, float, false)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Sum, int32_t, true)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Sum, int32_t, false)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Sum, float, true)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(BM_Sum, float, false)->Arg(1 << 20);
+
+BENCHMARK(BM_HashBytes)->Arg(16)->Arg(256)->Arg(4096);
+BENCHMARK(BM_CompareBytes)->Arg(16)->Arg(4096);
+
+BENCHMARK_MAIN();
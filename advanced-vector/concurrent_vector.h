@@ -0,0 +1,181 @@
+#pragma once
+
+#include "segments.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+// Вектор только для добавления, в который несколько потоков одновременно добавляют
+// элементы без блокировок. Элементы хранятся в сегментах удваивающегося размера,
+// поэтому их адреса не меняются, а читатели не видят переноса элементов.
+// У каждого элемента есть флаг готовности: индекс занимается раньше, чем элемент
+// создан, и читать элемент можно только после того, как IsReady вернул true
+// (или если индекс получен от EmplaceBack в том же потоке или через синхронизацию с ним).
+// Аллокатор вызывается из нескольких потоков сразу и должен это допускать
+template <typename T, typename Alloc = std::allocator<T>>
+class ConcurrentVector {
+public:
+    using allocator_type = Alloc;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const Alloc& alloc) noexcept
+    : alloc_(alloc) {
+    }
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    // Все добавления должны завершиться до разрушения вектора
+    ~ConcurrentVector() {
+        const size_t size = Size();
+        for (size_t segment = 0; segment != Layout::MAX_SEGMENTS; ++segment) {
+            Slot* slots = segments_[segment].load(std::memory_order_acquire);
+            if (slots == nullptr) {
+                continue;
+            }
+            const size_t start = Layout::SegmentStart(segment);
+            const size_t count = Layout::SegmentSize(segment);
+            for (size_t i = 0; i != count && start + i < size; ++i) {
+                if (slots[i].state.load(std::memory_order_acquire) == READY) {
+                    std::allocator_traits<Alloc>::destroy(alloc_, slots[i].Get());
+                }
+            }
+            DestroySegment(slots, segment);
+        }
+    }
+
+    // Создаёт элемент и возвращает его индекс. Потокобезопасен и не блокирует других
+    // писателей. Если конструктор или выделение памяти выбросят исключение, индекс
+    // остаётся занятым, но элемент по нему никогда не станет готовым
+    template <typename... Args>
+    size_t EmplaceBack(Args&&... args) {
+        const size_t index = next_.fetch_add(1, std::memory_order_relaxed);
+        if (index >= MaxSize()) {
+            throw std::length_error("ConcurrentVector: size exceeds MaxSize()");
+        }
+        const auto [segment, offset] = Layout::Locate(index);
+        Slot& slot = GetOrCreateSegment(segment)[offset];
+        try {
+            std::allocator_traits<Alloc>::construct(alloc_, slot.Get(), std::forward<Args>(args)...);
+        } catch (...) {
+            slot.state.store(FAILED, std::memory_order_release);
+            throw;
+        }
+        slot.state.store(READY, std::memory_order_release);
+        return index;
+    }
+
+    size_t PushBack(const T& value) {
+        return EmplaceBack(value);
+    }
+
+    size_t PushBack(T&& value) {
+        return EmplaceBack(std::move(value));
+    }
+
+    // Заранее выделяет сегменты под capacity элементов. Потокобезопасен
+    void Reserve(size_t capacity) {
+        if (capacity > MaxSize()) {
+            throw std::length_error("ConcurrentVector: requested capacity exceeds MaxSize()");
+        }
+        for (size_t segment = 0; segment != Layout::SegmentsFor(capacity); ++segment) {
+            GetOrCreateSegment(segment);
+        }
+    }
+
+    // Число занятых индексов. Элементы с меньшими индексами могут быть ещё не готовы
+    size_t Size() const noexcept {
+        return std::min(next_.load(std::memory_order_acquire), MaxSize());
+    }
+
+    static constexpr size_t MaxSize() noexcept {
+        return Layout::MAX_SIZE;
+    }
+
+    // Элемент по индексу index создан и его можно читать. Не ждёт других потоков
+    bool IsReady(size_t index) const noexcept {
+        if (index >= Size()) {
+            return false;
+        }
+        const auto [segment, offset] = Layout::Locate(index);
+        const Slot* slots = segments_[segment].load(std::memory_order_acquire);
+        return slots != nullptr && slots[offset].state.load(std::memory_order_acquire) == READY;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        const auto [segment, offset] = Layout::Locate(index);
+        Slot* slots = segments_[segment].load(std::memory_order_acquire);
+        assert(slots != nullptr && slots[offset].state.load(std::memory_order_acquire) == READY);
+        return *slots[offset].Get();
+    }
+
+    const Alloc& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+private:
+    // Первый сегмент вмещает 32 элемента
+    using Layout = detail::SegmentLayout<5>;
+
+    enum State : uint8_t { EMPTY, READY, FAILED };
+
+    // Элемент вместе с флагом готовности
+    struct Slot {
+        std::atomic<State> state{EMPTY};
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* Get() noexcept {
+            return std::launder(reinterpret_cast<T*>(storage));
+        }
+    };
+
+    using SlotAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Slot>;
+    using SlotTraits = std::allocator_traits<SlotAlloc>;
+
+    [[no_unique_address]] Alloc alloc_;
+    std::atomic<size_t> next_{0};
+    std::array<std::atomic<Slot*>, Layout::MAX_SEGMENTS> segments_{};
+
+    // Возвращает сегмент, выделяя его при первом обращении. Если несколько потоков
+    // выделили сегмент одновременно, остаётся сегмент первого из них
+    Slot* GetOrCreateSegment(size_t segment) {
+        Slot* slots = segments_[segment].load(std::memory_order_acquire);
+        if (slots != nullptr) {
+            return slots;
+        }
+        Slot* created = CreateSegment(segment);
+        if (segments_[segment].compare_exchange_strong(slots, created, std::memory_order_acq_rel,
+                                                       std::memory_order_acquire)) {
+            return created;
+        }
+        DestroySegment(created, segment);
+        return slots;
+    }
+
+    Slot* CreateSegment(size_t segment) {
+        SlotAlloc alloc(alloc_);
+        const size_t count = Layout::SegmentSize(segment);
+        Slot* slots = SlotTraits::allocate(alloc, count);
+        for (size_t i = 0; i != count; ++i) {
+            ::new (static_cast<void*>(slots + i)) Slot;
+        }
+        return slots;
+    }
+
+    void DestroySegment(Slot* slots, size_t segment) noexcept {
+        SlotAlloc alloc(alloc_);
+        SlotTraits::deallocate(alloc, slots, Layout::SegmentSize(segment));
+    }
+};
@@ -0,0 +1,372 @@
+#pragma once
+
+#include "vector.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+template <typename T, typename Alloc>
+class AtomicCowVector;
+
+// Вектор с разделяемым буфером: копирование стоит O(1) и только увеличивает счётчик
+// ссылок, а первая изменяющая операция над разделяемым буфером копирует его (копирование
+// при записи). Элементы, которые читали через другие копии, при этом не меняются.
+// Как и std::shared_ptr, один объект CowVector нельзя без синхронизации менять из
+// нескольких потоков, но разные копии одного буфера используются потоками независимо.
+// Неконстантные begin(), end() и operator[] отделяют буфер, даже если через них только читают
+template <typename T, typename Alloc = std::allocator<T>>
+class CowVector {
+public:
+    using Data = Vector<T, Alloc>;
+    using const_iterator = const T*;
+    using allocator_type = Alloc;
+
+    CowVector() = default;
+
+    explicit CowVector(const Alloc& alloc)
+    : alloc_(alloc) {
+    }
+
+    // Забирает элементы data без копирования
+    explicit CowVector(Data data)
+    : alloc_(data.GetAllocator())
+    , block_(CreateBlock(std::move(data)))  //
+    {
+    }
+
+    CowVector(const CowVector& other) noexcept
+    : alloc_(other.alloc_)
+    , block_(other.block_)  //
+    {
+        AddRef(block_);
+    }
+
+    CowVector(CowVector&& other) noexcept
+    : alloc_(other.alloc_)
+    , block_(std::exchange(other.block_, nullptr))  //
+    {
+    }
+
+    // Буфер разделяется, только если его сможет освободить аллокатор этого вектора.
+    // Иначе элементы rhs копируются в новый буфер
+    CowVector& operator=(const CowVector& rhs) noexcept(AllocTraits::propagate_on_container_copy_assignment::value
+                                                        || AllocTraits::is_always_equal::value) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                AddRef(rhs.block_);
+                Release(alloc_, std::exchange(block_, rhs.block_));
+                alloc_ = rhs.alloc_;
+            } else if (AllocTraits::is_always_equal::value || alloc_ == rhs.alloc_) {
+                AddRef(rhs.block_);
+                Release(alloc_, std::exchange(block_, rhs.block_));
+            } else {
+                Release(alloc_, std::exchange(block_, CopyBlock(rhs.block_)));
+            }
+        }
+        return *this;
+    }
+
+    CowVector& operator=(CowVector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                                   || AllocTraits::is_always_equal::value) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                Release(alloc_, std::exchange(block_, std::exchange(rhs.block_, nullptr)));
+                alloc_ = std::move(rhs.alloc_);
+            } else if (AllocTraits::is_always_equal::value || alloc_ == rhs.alloc_) {
+                Release(alloc_, std::exchange(block_, std::exchange(rhs.block_, nullptr)));
+            } else {
+                // Буфер rhs может быть разделён с другими копиями, поэтому элементы копируются
+                Release(alloc_, std::exchange(block_, CopyBlock(rhs.block_)));
+                rhs.Clear();
+            }
+        }
+        return *this;
+    }
+
+    ~CowVector() {
+        Release(alloc_, block_);
+    }
+
+    const_iterator begin() const noexcept {
+        return AsSpan().data();
+    }
+    const_iterator end() const noexcept {
+        return begin() + Size();
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    T* begin() {
+        return Mutable().begin();
+    }
+    T* end() {
+        return Mutable().end();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return block_->data[index];
+    }
+
+    T& operator[](size_t index) {
+        assert(index < Size());
+        return Mutable()[index];
+    }
+
+    size_t Size() const noexcept {
+        return block_ == nullptr ? 0 : block_->data.Size();
+    }
+
+    size_t Capacity() const noexcept {
+        return block_ == nullptr ? 0 : block_->data.Capacity();
+    }
+
+    std::span<const T> AsSpan() const noexcept {
+        return block_ == nullptr ? std::span<const T>() : std::as_const(block_->data).AsSpan();
+    }
+
+    // Число копий, разделяющих буфер (включая эту). У пустого вектора без буфера равно 0
+    size_t UseCount() const noexcept {
+        return block_ == nullptr ? 0 : block_->refs.load(std::memory_order_acquire);
+    }
+
+    bool IsShared() const noexcept {
+        return UseCount() > 1;
+    }
+
+    const Alloc& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Вектор, которым владеет только этот объект. Разделяемый буфер копируется
+    Data& Mutable() {
+        if (block_ == nullptr) {
+            block_ = CreateBlock(Data(alloc_));
+        } else if (block_->refs.load(std::memory_order_acquire) != 1) {
+            Block* copy = CreateBlock(Data(block_->data, alloc_));
+            Release(alloc_, std::exchange(block_, copy));
+        }
+        return block_->data;
+    }
+
+    // Изменяющие операции. Аргументы могут ссылаться на элементы вектора: отделённый
+    // буфер остаётся живым, пока на него ссылаются другие копии
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        return Mutable().EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename... Args>
+    T* Emplace(const_iterator pos, Args&&... args) {
+        const size_t index = pos - cbegin();
+        Data& data = Mutable();
+        return data.Emplace(data.cbegin() + index, std::forward<Args>(args)...);
+    }
+
+    T* Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    T* Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    T* Erase(const_iterator pos) {
+        return Erase(pos, pos + 1);
+    }
+
+    T* Erase(const_iterator first, const_iterator last) {
+        const size_t index = first - cbegin();
+        const size_t count = last - first;
+        Data& data = Mutable();
+        return data.Erase(data.cbegin() + index, data.cbegin() + index + count);
+    }
+
+    void PopBack() {
+        assert(Size() != 0);
+        Mutable().PopBack();
+    }
+
+    void Resize(size_t new_size) {
+        Mutable().Resize(new_size);
+    }
+
+    void Reserve(size_t new_capacity) {
+        Mutable().Reserve(new_capacity);
+    }
+
+    // Разделяемый буфер не копируется, а просто отпускается
+    void Clear() noexcept {
+        Release(alloc_, std::exchange(block_, nullptr));
+    }
+
+    // Аллокаторы обмениваются, только если это разрешает propagate_on_container_swap,
+    // иначе аллокаторы обоих векторов должны быть равны
+    void Swap(CowVector& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(AllocTraits::is_always_equal::value || alloc_ == other.alloc_);
+        }
+        std::swap(block_, other.block_);
+    }
+
+private:
+    friend class AtomicCowVector<T, Alloc>;
+
+    // Разделяемый буфер и число ссылающихся на него копий
+    struct Block {
+        explicit Block(Data data) noexcept
+        : data(std::move(data))  //
+        {
+        }
+
+        std::atomic<size_t> refs{1};
+        Data data;
+    };
+
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using BlockAlloc = typename AllocTraits::template rebind_alloc<Block>;
+    using BlockTraits = std::allocator_traits<BlockAlloc>;
+
+    [[no_unique_address]] Alloc alloc_;
+    Block* block_ = nullptr;
+
+    // Принимает ссылку на block, которую вызывающий уже учёл в счётчике
+    CowVector(const Alloc& alloc, Block* block) noexcept
+    : alloc_(alloc)
+    , block_(block)  //
+    {
+    }
+
+    Block* CreateBlock(Data data) const {
+        BlockAlloc alloc(alloc_);
+        Block* block = BlockTraits::allocate(alloc, 1);
+        ::new (static_cast<void*>(block)) Block(std::move(data));
+        return block;
+    }
+
+    // Новый буфер с копией элементов block, выделенный аллокатором этого вектора
+    Block* CopyBlock(const Block* block) const {
+        return block == nullptr ? nullptr : CreateBlock(Data(block->data, alloc_));
+    }
+
+    static void AddRef(Block* block, size_t count = 1) noexcept {
+        if (block != nullptr) {
+            block->refs.fetch_add(count, std::memory_order_relaxed);
+        }
+    }
+
+    // Отпускает ссылку на block. Последняя ссылка освобождает буфер
+    static void Release(const Alloc& alloc, Block* block) noexcept {
+        if (block != nullptr && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            BlockAlloc block_alloc(alloc);
+            block->~Block();
+            BlockTraits::deallocate(block_alloc, block, 1);
+        }
+    }
+};
+
+// Ячейка, через которую писатель публикует снимки CowVector, а читатели забирают
+// последний снимок. Load и Store не используют блокировок и могут вызываться из любых
+// потоков одновременно. Снимок, полученный читателем, остаётся неизменным и живым,
+// пока читатель его держит, даже если писатель уже опубликовал следующий.
+// Указатель на буфер и число читателей, которые прямо сейчас забирают его в Load,
+// хранятся в одном 64-битном слове (раздельный подсчёт ссылок). Писатель при замене
+// переносит это число в счётчик ссылок буфера
+template <typename T, typename Alloc = std::allocator<T>>
+class AtomicCowVector {
+    using Cow = CowVector<T, Alloc>;
+    using Block = typename Cow::Block;
+
+public:
+    AtomicCowVector() = default;
+
+    explicit AtomicCowVector(Cow snapshot) noexcept
+    : alloc_(snapshot.alloc_)
+    , word_(Pack(std::exchange(snapshot.block_, nullptr)))  //
+    {
+    }
+
+    AtomicCowVector(const AtomicCowVector&) = delete;
+    AtomicCowVector& operator=(const AtomicCowVector&) = delete;
+
+    ~AtomicCowVector() {
+        Replace(nullptr);
+    }
+
+    // Последний опубликованный снимок
+    Cow Load() const noexcept {
+        // Резервирует ссылку в слове, пока буфер не может быть освобождён писателем
+        const uint64_t reserved = word_.fetch_add(1, std::memory_order_acquire);
+        assert((reserved & COUNT_MASK) != COUNT_MASK);
+        Block* block = Unpack(reserved);
+        Cow::AddRef(block);
+        // Возвращает резерв в слово. Если писатель успел заменить буфер, он перенёс
+        // резервы в счётчик ссылок буфера, и лишняя ссылка отпускается. Резервы одного
+        // буфера взаимозаменяемы, поэтому важно лишь, что каждый Load либо возвращает
+        // один резерв, либо отпускает одну ссылку
+        uint64_t current = word_.load(std::memory_order_relaxed);
+        while (Unpack(current) == block && (current & COUNT_MASK) != 0) {
+            if (word_.compare_exchange_weak(current, current - 1, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+                return Cow(alloc_, block);
+            }
+        }
+        Cow::Release(alloc_, block);
+        return Cow(alloc_, block);
+    }
+
+    // Публикует снимок. Читатели предыдущего снимка продолжают видеть его.
+    // Снимок должен быть получен от аллокатора, равного аллокатору ячейки: ячейка
+    // освобождает буферы своим аллокатором
+    void Store(Cow snapshot) noexcept {
+        assert(Cow::AllocTraits::is_always_equal::value || alloc_ == snapshot.alloc_);
+        Replace(std::exchange(snapshot.block_, nullptr));
+    }
+
+private:
+    static constexpr int COUNT_BITS = 16;
+    static constexpr uint64_t COUNT_MASK = (uint64_t{1} << COUNT_BITS) - 1;
+
+    static_assert(sizeof(void*) == sizeof(uint64_t), "AtomicCowVector требует 64-битных указателей");
+
+    [[no_unique_address]] Alloc alloc_;
+    // Указатель на буфер в старших 48 битах и число незавершённых Load в младших 16
+    mutable std::atomic<uint64_t> word_{0};
+
+    static uint64_t Pack(Block* block) noexcept {
+        const auto address = reinterpret_cast<uintptr_t>(block);
+        assert((address >> (64 - COUNT_BITS)) == 0);
+        return static_cast<uint64_t>(address) << COUNT_BITS;
+    }
+
+    static Block* Unpack(uint64_t word) noexcept {
+        return reinterpret_cast<Block*>(static_cast<uintptr_t>(word >> COUNT_BITS));
+    }
+
+    // Ставит в ячейку block, ссылку на который ячейка забирает, и отпускает прежний
+    void Replace(Block* block) noexcept {
+        const uint64_t old = word_.exchange(Pack(block), std::memory_order_acq_rel);
+        if (Block* old_block = Unpack(old)) {
+            // Резервы незавершённых Load становятся ссылками, которые они отпустят сами
+            Cow::AddRef(old_block, old & COUNT_MASK);
+            Cow::Release(alloc_, old_block);
+        }
+    }
+};
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "allocators.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#endif
+
+// Размещение памяти по узлам NUMA. Узлы задаются битовой маской: бит i означает узел i
+struct NumaPolicy {
+    enum Mode : uint8_t { LOCAL, BIND, INTERLEAVE };
+
+    // Страницы выделяются на узле потока, который первым к ним обратится
+    static constexpr NumaPolicy Local() noexcept {
+        return {LOCAL, 0};
+    }
+
+    // Все страницы выделяются на узле node
+    static constexpr NumaPolicy Bind(int node) noexcept {
+        assert(node >= 0 && node < 64);
+        return {BIND, uint64_t{1} << node};
+    }
+
+    // Страницы по очереди распределяются между узлами маски nodes, чтобы потоки
+    // всех узлов получали к буферу одинаковую пропускную способность
+    static constexpr NumaPolicy Interleave(uint64_t nodes) noexcept {
+        return {INTERLEAVE, nodes};
+    }
+
+    Mode mode = LOCAL;
+    uint64_t nodes = 0;
+};
+
+// Аллокатор для очень больших буферов. Блоки от THRESHOLD байтов отображаются через mmap
+// целыми большими страницами по 2 МиБ: сначала из страниц hugetlbfs (MAP_HUGETLB),
+// зарезервированных администратором, а при их нехватке из обычной памяти, выровненной
+// по 2 МиБ, с подсказкой MADV_HUGEPAGE для прозрачных больших страниц. Такой буфер
+// размещается по узлам NUMA согласно политике аллокатора. Меньшие блоки выделяет
+// std::allocator. Запас до границы большой страницы Vector получает через
+// allocate_at_least и использует как вместимость.
+// Все экземпляры аллокатора равны: политика влияет только на новые выделения
+template <typename T, size_t THRESHOLD = (size_t{64} << 20)>
+class HugePageAllocator {
+public:
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    static constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+
+    template <typename U>
+    struct rebind {
+        using other = HugePageAllocator<U, THRESHOLD>;
+    };
+
+    HugePageAllocator() noexcept = default;
+
+    explicit HugePageAllocator(NumaPolicy numa) noexcept
+    : numa_(numa) {
+    }
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U, THRESHOLD>& other) noexcept
+    : numa_(other.GetNumaPolicy()) {
+    }
+
+    NumaPolicy GetNumaPolicy() const noexcept {
+        return numa_;
+    }
+
+    T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    AllocationResult<T> allocate_at_least(size_t n) {
+        const size_t bytes = ByteCount(n);
+        if (bytes < THRESHOLD) {
+            return {std::allocator<T>().allocate(n), n};
+        }
+        const size_t mapped = MappedBytes(bytes);
+        return {static_cast<T*>(Map(mapped)), mapped / sizeof(T)};
+    }
+
+    // Способ освобождения зависит только от размера, поэтому совпадает со способом выделения
+    void deallocate(T* p, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (bytes < THRESHOLD) {
+            std::allocator<T>().deallocate(p, n);
+        } else {
+            ::munmap(p, MappedBytes(bytes));
+        }
+    }
+
+    template <typename U>
+    bool operator==(const HugePageAllocator<U, THRESHOLD>& /*other*/) const noexcept {
+        return true;
+    }
+
+private:
+    NumaPolicy numa_;
+
+    static size_t ByteCount(size_t n) {
+        if (n > (std::numeric_limits<size_t>::max() - 2 * HUGE_PAGE_SIZE) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return n * sizeof(T);
+    }
+
+    static size_t MappedBytes(size_t bytes) noexcept {
+        return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    }
+
+    // Отображает bytes байтов, кратных размеру большой страницы, по адресу, выровненному
+    // по большой странице. Страницы ещё не выделены, поэтому политика NUMA применяется ко всем
+    void* Map(size_t bytes) const {
+        constexpr int PROTECTION = PROT_READ | PROT_WRITE;
+        constexpr int FLAGS = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+        void* huge = ::mmap(nullptr, bytes, PROTECTION, FLAGS | MAP_HUGETLB | (21 << MAP_HUGE_SHIFT), -1, 0);
+        if (huge != MAP_FAILED) {
+            return ApplyNumaPolicy(huge, bytes);
+        }
+#endif
+        // Лишняя большая страница позволяет выровнять начало, после чего излишки отрезаются
+        void* raw = ::mmap(nullptr, bytes + HUGE_PAGE_SIZE, PROTECTION, FLAGS, -1, 0);
+        if (raw == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        auto* begin = static_cast<std::byte*>(raw);
+        const size_t head = (HUGE_PAGE_SIZE - reinterpret_cast<uintptr_t>(begin) % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+        if (head != 0) {
+            ::munmap(begin, head);
+        }
+        if (head != HUGE_PAGE_SIZE) {
+            ::munmap(begin + head + bytes, HUGE_PAGE_SIZE - head);
+        }
+        void* address = begin + head;
+#if defined(MADV_HUGEPAGE)
+        // Подсказка необязательна: без поддержки ядра память остаётся обычной
+        ::madvise(address, bytes, MADV_HUGEPAGE);
+#endif
+        return ApplyNumaPolicy(address, bytes);
+    }
+
+    // Привязывает ещё не выделенные страницы к узлам NUMA. При ошибке память освобождается
+    void* ApplyNumaPolicy(void* address, size_t bytes) const {
+        if (numa_.mode == NumaPolicy::LOCAL) {
+            return address;
+        }
+#if defined(__linux__) && defined(SYS_mbind)
+        const int mode = numa_.mode == NumaPolicy::BIND ? MPOL_BIND : MPOL_INTERLEAVE;
+        const unsigned long nodes = numa_.nodes;
+        // Ядро считает маску на один бит длиннее, чем читает
+        constexpr unsigned long MAX_NODE = sizeof(nodes) * 8 + 1;
+        if (::syscall(SYS_mbind, address, bytes, mode, &nodes, MAX_NODE, 0) != 0) {
+            const int error = errno;
+            ::munmap(address, bytes);
+            throw std::system_error(error, std::generic_category(), "HugePageAllocator: mbind");
+        }
+#endif
+        return address;
+    }
+};
@@ -0,0 +1,293 @@
+#pragma once
+
+#include "index_iterator.h"
+#include "vector.h"
+
+#include <span>
+#include <utility>
+
+// Вектор для кода, чувствительного к задержкам: рост не переносит все элементы разом.
+// Когда место кончается, IncrementalVector выделяет новый буфер и кладёт новый элемент
+// сразу туда, а старые элементы переносятся в новый буфер понемногу каждым следующим
+// EmplaceBack. Шаг переноса выбирается так, чтобы перенос закончился раньше, чем
+// заполнится новый буфер, поэтому EmplaceBack переносит O(1) элементов и в худшем случае.
+// Пока перенос идёт, элемент с индексом i лежит в старом буфере при i < PendingMigration()
+// и в новом иначе; operator[] выбирает нужный буфер. Ссылки на элементы, ещё не
+// перенесённые в новый буфер, становятся недействительными при их переносе
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+class IncrementalVector {
+public:
+    using iterator = detail::IndexIterator<IncrementalVector, T, false>;
+    using const_iterator = detail::IndexIterator<IncrementalVector, T, true>;
+    using allocator_type = Alloc;
+
+    // Наименьшее число элементов, переносимых за один шаг. Тривиально перемещаемые
+    // элементы переносятся одним memcpy, поэтому за шаг переносится не меньше 4 КиБ
+    static constexpr size_t MIN_MIGRATION_STEP = IsTriviallyRelocatableV<T> ? std::max<size_t>(4096 / sizeof(T), 1) : 1;
+
+    IncrementalVector() = default;
+
+    explicit IncrementalVector(const Alloc& alloc) noexcept
+    : data_(alloc)
+    , old_(alloc) {
+    }
+
+    IncrementalVector(const IncrementalVector& other)
+    : IncrementalVector(AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+        Reserve(other.size_);
+        for (const T& value : other) {
+            EmplaceBack(value);
+        }
+    }
+
+    IncrementalVector(IncrementalVector&& other) noexcept
+    : data_(std::move(other.data_))
+    , old_(std::move(other.old_))
+    , size_(std::exchange(other.size_, 0))
+    , pending_(std::exchange(other.pending_, 0))
+    , step_(other.step_) {
+    }
+
+    IncrementalVector& operator=(const IncrementalVector& rhs) {
+        if (this != &rhs) {
+            IncrementalVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    IncrementalVector& operator=(IncrementalVector&& rhs) noexcept {
+        if (this != &rhs) {
+            IncrementalVector rhs_copy(std::move(rhs));
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    ~IncrementalVector() {
+        Clear();
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<IncrementalVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return index < pending_ ? old_[index] : data_[index];
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    size_t MaxSize() const noexcept {
+        return std::min<size_t>(AllocTraits::max_size(data_.GetAllocator()),
+                                std::numeric_limits<std::ptrdiff_t>::max() / sizeof(T));
+    }
+
+    const Alloc& GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    // Число элементов в начале вектора, которые ещё лежат в старом буфере
+    size_t PendingMigration() const noexcept {
+        return pending_;
+    }
+
+    bool IsMigrating() const noexcept {
+        return pending_ != 0;
+    }
+
+    // Переносит до count элементов, например в свободное время цикла событий.
+    // Если перенос элемента выбросит исключение, он остаётся в старом буфере
+    void Migrate(size_t count) {
+        count = std::min(count, pending_);
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            pending_ -= count;
+            Ops::CopyBytes(data_.GetAddress() + pending_, old_.GetAddress() + pending_, count);
+        } else {
+            for (size_t i = 0; i != count; ++i) {
+                T* from = old_.GetAddress() + pending_ - 1;
+                Ops::Construct(Allocator(), data_.GetAddress() + pending_ - 1, std::move_if_noexcept(*from));
+                Ops::Destroy(Allocator(), from);
+                --pending_;
+            }
+            if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+                Stats::OnMove(count);
+            } else {
+                Stats::OnCopy(count);
+            }
+        }
+        if (pending_ == 0) {
+            ReleaseOld();
+        }
+    }
+
+    void FinishMigration() {
+        Migrate(pending_);
+    }
+
+    // Элементы одним непрерывным участком. Если перенос идёт, сначала завершает его
+    std::span<T> AsSpan() {
+        FinishMigration();
+        return {data_.GetAddress(), size_};
+    }
+
+    // Аргументы могут ссылаться на элементы вектора
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            return GrowAndEmplace(std::forward<Args>(args)...);
+        }
+        T* slot = data_.GetAddress() + size_;
+        Ops::Construct(Allocator(), slot, std::forward<Args>(args)...);
+        ++size_;
+        if (pending_ != 0) {
+            try {
+                Migrate(step_);
+            } catch (...) {
+                PopBack();
+                throw;
+            }
+        }
+        return *slot;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        --size_;
+        if (size_ < pending_) {
+            // В новом буфере элементов не осталось
+            Ops::Destroy(Allocator(), old_.GetAddress() + size_);
+            pending_ = size_;
+            if (pending_ == 0) {
+                ReleaseOld();
+            }
+        } else {
+            Ops::Destroy(Allocator(), data_.GetAddress() + size_);
+        }
+    }
+
+    // Явное резервирование завершает перенос и переносит элементы сразу
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        if (new_capacity > MaxSize()) {
+            throw std::length_error("IncrementalVector: requested capacity exceeds MaxSize()");
+        }
+        FinishMigration();
+        Stats::OnReallocate(Capacity());
+        Memory new_data(new_capacity, GetAllocator());
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            Ops::CopyBytes(new_data.GetAddress(), data_.GetAddress(), size_);
+        } else {
+            Ops::CopyOrMoveData(Allocator(), data_.GetAddress(), size_, new_data.GetAddress());
+            Ops::DestroyN(Allocator(), data_.GetAddress(), size_);
+        }
+        data_.Swap(new_data);
+    }
+
+    // Разрушает элементы. Старый буфер освобождается, новый остаётся
+    void Clear() noexcept {
+        Ops::DestroyN(Allocator(), old_.GetAddress(), pending_);
+        Ops::DestroyN(Allocator(), data_.GetAddress() + pending_, size_ - pending_);
+        size_ = 0;
+        pending_ = 0;
+        ReleaseOld();
+    }
+
+    void Swap(IncrementalVector& other) noexcept {
+        data_.Swap(other.data_);
+        old_.Swap(other.old_);
+        std::swap(size_, other.size_);
+        std::swap(pending_, other.pending_);
+        std::swap(step_, other.step_);
+    }
+
+private:
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using Memory = RawMemory<T, Alloc>;
+    using Ops = detail::ElementOps<T, Alloc>;
+    using Stats = detail::StatsHooks<T>;
+
+    Memory data_;
+    // Буфер, из которого ещё не перенесены первые pending_ элементов
+    Memory old_;
+    size_t size_ = 0;
+    size_t pending_ = 0;
+    // Число элементов, переносимых каждым EmplaceBack
+    size_t step_ = MIN_MIGRATION_STEP;
+
+    Alloc& Allocator() noexcept {
+        return data_.GetAllocator();
+    }
+
+    // Создаёт элемент в новом буфере и начинает перенос в него остальных элементов.
+    // Сам этот вызов элементы не переносит
+    template <typename... Args>
+    T& GrowAndEmplace(Args&&... args) {
+        if (size_ == MaxSize()) {
+            throw std::length_error("IncrementalVector: size exceeds MaxSize()");
+        }
+        // Обычно шаг переноса заканчивает перенос раньше, чем заполнится буфер. Если нет
+        // (буфер вырос на один элемент или перенос прерывался исключением), перенос
+        // завершается здесь
+        FinishMigration();
+        const size_t required = size_ + 1;
+        const size_t new_capacity = std::clamp(Growth::NextCapacity(Capacity(), required, sizeof(T)), required, MaxSize());
+        Stats::OnGrowth(required, new_capacity);
+        Memory new_data(new_capacity, GetAllocator());
+        T* slot = new_data.GetAddress() + size_;
+        Ops::Construct(Allocator(), slot, std::forward<Args>(args)...);
+
+        Stats::OnReallocate(Capacity());
+        old_.Swap(data_);
+        data_.Swap(new_data);
+        pending_ = size_;
+        ++size_;
+        const size_t free = std::max<size_t>(new_capacity - size_, 1);
+        step_ = std::max((pending_ + free - 1) / free, MIN_MIGRATION_STEP);
+        if (pending_ == 0) {
+            ReleaseOld();
+        }
+        return *slot;
+    }
+
+    void ReleaseOld() noexcept {
+        Memory empty(GetAllocator());
+        old_.Swap(empty);
+    }
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace detail {
+
+// Итератор произвольного доступа по индексу для контейнеров, элементы которых
+// не лежат в памяти подряд. Обращается к элементам через Container::operator[]
+template <typename Container, typename T, bool IS_CONST>
+class IndexIterator {
+public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<IS_CONST, const T*, T*>;
+    using reference = std::conditional_t<IS_CONST, const T&, T&>;
+    using Owner = std::conditional_t<IS_CONST, const Container, Container>;
+
+    IndexIterator() = default;
+
+    IndexIterator(Owner* owner, size_t index) noexcept
+    : owner_(owner)
+    , index_(index) {
+    }
+
+    // Неконстантный итератор приводится к константному
+    template <bool OTHER_CONST>
+        requires(IS_CONST && !OTHER_CONST)
+    IndexIterator(const IndexIterator<Container, T, OTHER_CONST>& other) noexcept
+    : owner_(other.owner_)
+    , index_(other.index_) {
+    }
+
+    reference operator*() const noexcept {
+        return (*owner_)[index_];
+    }
+    pointer operator->() const noexcept {
+        return &**this;
+    }
+    reference operator[](difference_type n) const noexcept {
+        return (*owner_)[index_ + n];
+    }
+
+    IndexIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+    IndexIterator operator++(int) noexcept {
+        IndexIterator old = *this;
+        ++index_;
+        return old;
+    }
+    IndexIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+    IndexIterator operator--(int) noexcept {
+        IndexIterator old = *this;
+        --index_;
+        return old;
+    }
+
+    IndexIterator& operator+=(difference_type n) noexcept {
+        index_ += n;
+        return *this;
+    }
+    IndexIterator& operator-=(difference_type n) noexcept {
+        index_ -= n;
+        return *this;
+    }
+    friend IndexIterator operator+(IndexIterator it, difference_type n) noexcept {
+        return it += n;
+    }
+    friend IndexIterator operator+(difference_type n, IndexIterator it) noexcept {
+        return it += n;
+    }
+    friend IndexIterator operator-(IndexIterator it, difference_type n) noexcept {
+        return it -= n;
+    }
+    friend difference_type operator-(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    bool operator==(const IndexIterator& other) const noexcept {
+        return index_ == other.index_;
+    }
+    auto operator<=>(const IndexIterator& other) const noexcept {
+        return index_ <=> other.index_;
+    }
+
+private:
+    template <typename, typename, bool>
+    friend class IndexIterator;
+
+    Owner* owner_ = nullptr;
+    size_t index_ = 0;
+};
+
+}  // namespace detail
@@ -1,7 +1,41 @@
+// Тесты проверяют и счётчики статистики, поэтому инструментирование включено. С макросом
+// VECTOR_TESTS_WITHOUT_STATS тесты собираются без него и проверяют, что точки сбора пусты
+#ifndef VECTOR_TESTS_WITHOUT_STATS
+#define VECTOR_ENABLE_STATS
+#endif
+
 #include "vector.h"
+#include "allocators.h"
+#include "concurrent_vector.h"
+#include "huge_page_allocator.h"
+#include "incremental_vector.h"
+#include "cow_vector.h"
+#include "mapped_vector.h"
+#include "parallel.h"
+#include "persistent_vector.h"
+#include "ring_vector.h"
+#include "segmented_vector.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "static_vector.h"
+#include "vector_algorithms.h"
+#include "vector_io.h"
 
+#include <array>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <stdexcept>
+#include <string_view>
 #include <string>
 #include <vector>
 
@@ -116,8 +150,156 @@ namespace {
         static inline int num_move_assigned = 0;
     };
 
+    // Статистика "арены", из которой ArenaAllocator выделяет память
+    struct ArenaStats {
+        int allocations = 0;
+        int deallocations = 0;
+        int constructions = 0;
+    };
+
+    // Аллокатор с состоянием: аллокаторы равны, только если работают с одной ареной
+    template <typename T, bool Propagate = true>
+    struct ArenaAllocator {
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::bool_constant<Propagate>;
+        using propagate_on_container_move_assignment = std::bool_constant<Propagate>;
+        using propagate_on_container_swap = std::bool_constant<Propagate>;
+
+        template <typename U>
+        struct rebind {
+            using other = ArenaAllocator<U, Propagate>;
+        };
+
+        explicit ArenaAllocator(ArenaStats* stats) noexcept
+        : stats(stats)  //
+        {
+        }
+
+        template <typename U>
+        ArenaAllocator(const ArenaAllocator<U, Propagate>& other) noexcept
+        : stats(other.stats)  //
+        {
+        }
+
+        T* allocate(size_t n) {
+            ++stats->allocations;
+            return std::allocator<T>{}.allocate(n);
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            ++stats->deallocations;
+            std::allocator<T>{}.deallocate(p, n);
+        }
+
+        template <typename U, typename... Args>
+        void construct(U* p, Args&&... args) {
+            ++stats->constructions;
+            new (p) U(std::forward<Args>(args)...);
+        }
+
+        template <typename U>
+        bool operator==(const ArenaAllocator<U, Propagate>& other) const noexcept {
+            return stats == other.stats;
+        }
+
+        ArenaStats* stats;
+    };
+
+    // Дескриптор, который считает перемещения. Тривиально перемещаем по специализации ниже
+    struct Handle {
+        explicit Handle(int id) noexcept
+        : id(id)  //
+        {
+        }
+        Handle(Handle&& other) noexcept
+        : id(std::exchange(other.id, 0))  //
+        {
+            ++num_moved;
+        }
+        Handle& operator=(Handle&& other) noexcept {
+            id = std::exchange(other.id, 0);
+            ++num_moved;
+            return *this;
+        }
+        ~Handle() {
+            ++num_destroyed;
+        }
+
+        int id;
+
+        static inline int num_moved = 0;
+        static inline int num_destroyed = 0;
+    };
+
+    // Аллокатор, выделяющий блоки с запасом: блок расширяется на месте до BLOCK элементов
+    template <typename T, size_t BLOCK = 64>
+    struct ExpandableAllocator {
+        using value_type = T;
+
+        ExpandableAllocator() noexcept = default;
+
+        template <typename U>
+        ExpandableAllocator(const ExpandableAllocator<U, BLOCK>& /*other*/) noexcept {
+        }
+
+        T* allocate(size_t n) {
+            return std::allocator<T>{}.allocate(std::max(n, BLOCK));
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            std::allocator<T>{}.deallocate(p, std::max(n, BLOCK));
+        }
+
+        bool expand_in_place(T* /*p*/, size_t old_n, size_t new_n) noexcept {
+            ++num_expanded;
+            return std::max(old_n, BLOCK) >= new_n;
+        }
+
+        bool operator==(const ExpandableAllocator&) const noexcept {
+            return true;
+        }
+
+        static inline int num_expanded = 0;
+    };
+
+
+    // Типы с собственными счётчиками статистики
+    struct StatsPoint {
+        int x = 0;
+        int y = 0;
+    };
+
+    struct StatsKeyA {
+        int value = 0;
+    };
+
+    struct StatsKeyB {
+        int value = 0;
+    };
+
+    // Общий тег для статистики StatsKeyA и StatsKeyB
+    struct StatsKeyGroup {};
+
+    // Сколько из count выделений памяти попадёт в счётчики: без статистики ни одного
+    constexpr uint64_t CountedAllocations(uint64_t count) noexcept {
+        return VECTOR_STATS_ENABLED ? count : 0;
+    }
+
 }  // namespace
 
+template <>
+struct IsTriviallyRelocatable<Handle> : std::true_type {};
+
+template <>
+struct VectorStatsTag<StatsKeyA> {
+    using type = StatsKeyGroup;
+};
+
+template <>
+struct VectorStatsTag<StatsKeyB> {
+    using type = StatsKeyGroup;
+};
+
 void Test1() {
     Obj::ResetCounters();
     const size_t SIZE = 100500;
@@ -558,85 +740,2426 @@ void Test6() {
     }
 }
 
-struct C {
-    C() noexcept {
-        ++def_ctor;
+void Test7() {
+    static_assert(sizeof(Vector<int>) == sizeof(int*) + 2 * sizeof(size_t));
+    static_assert(sizeof(RawMemory<int>) == sizeof(int*) + sizeof(size_t));
+    const size_t SIZE = 10;
+    {
+        ArenaStats stats;
+        {
+            Vector<Obj, ArenaAllocator<Obj>> v{ArenaAllocator<Obj>{&stats}};
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.EmplaceBack(static_cast<int>(i));
+            }
+            assert(v.Size() == SIZE);
+            assert(stats.allocations > 0);
+            assert(stats.constructions >= static_cast<int>(SIZE));
+
+            const auto v_copy(v);
+            assert(v_copy.GetAllocator() == v.GetAllocator());
+            assert(v_copy[SIZE - 1].id == static_cast<int>(SIZE - 1));
+        }
+        assert(stats.allocations == stats.deallocations);
     }
-    C(const C& /*other*/) noexcept {
-        ++copy_ctor;
+    {
+        // Распространяемый аллокатор переходит вместе с памятью
+        ArenaStats stats1;
+        ArenaStats stats2;
+        {
+            using Alloc = ArenaAllocator<int>;
+            Vector<int, Alloc> v1(SIZE, Alloc{&stats1});
+            Vector<int, Alloc> v2(SIZE / 2, Alloc{&stats2});
+            v2 = v1;
+            assert(v2.GetAllocator().stats == &stats1);
+            assert(v2.Size() == SIZE);
+            Vector<int, Alloc> v3(1, Alloc{&stats2});
+            v3 = std::move(v1);
+            assert(v3.GetAllocator().stats == &stats1);
+            assert(v3.Size() == SIZE);
+            v3.Swap(v2);
+            assert(stats2.allocations == 2);
+        }
+        assert(stats1.allocations == stats1.deallocations);
+        assert(stats2.allocations == stats2.deallocations);
     }
-    C(C&& /*other*/) noexcept {
-        ++move_ctor;
+    {
+        // Нераспространяемый аллокатор остаётся на месте, элементы перемещаются по одному
+        ArenaStats stats1;
+        ArenaStats stats2;
+        {
+            using Alloc = ArenaAllocator<Obj, false>;
+            Obj::ResetCounters();
+            Vector<Obj, Alloc> v1(SIZE, Alloc{&stats1});
+            Vector<Obj, Alloc> v2(Alloc{&stats2});
+            v2 = std::move(v1);
+            assert(v2.GetAllocator().stats == &stats2);
+            assert(v2.Size() == SIZE);
+            assert(Obj::num_moved == static_cast<int>(SIZE));
+            assert(stats2.allocations == 1);
+        }
+        assert(stats1.allocations == stats1.deallocations);
+        assert(stats2.allocations == stats2.deallocations);
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    C& operator=(const C& other) noexcept {
-        if (this != &other) {
-            ++copy_assign;
+}
+
+void Test8() {
+    using namespace std::literals;
+    const size_t SIZE = 100;
+    {
+        // Вся память берётся из буфера на стеке, обращение к куче привело бы к исключению
+        std::byte buffer[4096];
+        std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        pmr::Vector<int> v(&resource);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
         }
-        return *this;
+        assert(v.Size() == SIZE);
+        assert(v[SIZE - 1] == static_cast<int>(SIZE - 1));
+        assert(v.GetAllocator().resource() == &resource);
+    }
+    {
+        // Элементы, поддерживающие аллокаторы, получают ресурс вектора
+        std::pmr::unsynchronized_pool_resource pool;
+        pmr::Vector<std::pmr::string> v(&pool);
+        v.EmplaceBack("a string long enough to leave the small buffer"s);
+        v.EmplaceBack(v[0]);
+        assert(v[0].get_allocator().resource() == &pool);
+        assert(v[1].get_allocator().resource() == &pool);
+
+        // Копия получает ресурс по умолчанию, а перемещение в вектор с другим ресурсом
+        // переносит элементы по одному
+        pmr::Vector<std::pmr::string> v_copy(v);
+        assert(v_copy.GetAllocator().resource() == std::pmr::get_default_resource());
+        std::pmr::unsynchronized_pool_resource other_pool;
+        pmr::Vector<std::pmr::string> v_other(&other_pool);
+        v_other = std::move(v);
+        assert(v_other.Size() == 2);
+        assert(v_other.GetAllocator().resource() == &other_pool);
+        assert(v_other[1].get_allocator().resource() == &other_pool);
     }
-    C& operator=(C&& /*other*/) noexcept {
-        ++move_assign;
-        return *this;
+}
+
+void Test9() {
+    const size_t SIZE = 10;
+    static_assert(IsTriviallyRelocatableV<int>);
+    static_assert(IsTriviallyRelocatableV<std::unique_ptr<int>>);
+    static_assert(IsTriviallyRelocatableV<Handle>);
+    static_assert(!IsTriviallyRelocatableV<Obj>);
+    {
+        Handle::num_moved = 0;
+        Handle::num_destroyed = 0;
+        {
+            Vector<Handle> v;
+            for (size_t i = 1; i <= SIZE; ++i) {
+                v.EmplaceBack(static_cast<int>(i));
+            }
+            v.Reserve(SIZE * 4);
+            v.Emplace(v.begin() + 2, 100);
+            v.Erase(v.begin());
+            assert(v.Size() == SIZE);
+            assert(v[0].id == 2);
+            assert(v[1].id == 100);
+            assert(v[2].id == 3);
+            assert(v[SIZE - 1].id == static_cast<int>(SIZE));
+            // Перенос элементов не вызывает ни конструкторов перемещения, ни деструкторов
+            assert(Handle::num_moved == 0);
+            assert(Handle::num_destroyed == 1);
+        }
+        assert(Handle::num_destroyed == static_cast<int>(SIZE) + 1);
     }
-    ~C() {
-        ++dtor;
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(std::make_unique<int>(static_cast<int>(i)));
+        }
+        v.Insert(v.begin(), std::make_unique<int>(-1));
+        v.Insert(v.begin() + 5, std::move(v[0]));
+        v.Erase(v.begin() + 1);
+        assert(v.Size() == SIZE + 1);
+        assert(v[0] == nullptr);
+        assert(*v[1] == 1);
+        assert(*v[4] == -1);
+        assert(*v[SIZE] == static_cast<int>(SIZE - 1));
     }
+}
 
-    static void Reset() {
-        def_ctor = 0;
-        copy_ctor = 0;
-        move_ctor = 0;
-        copy_assign = 0;
-        move_assign = 0;
-        dtor = 0;
+void Test10() {
+    const size_t SIZE = 100'000;
+    {
+        Vector<uint32_t, MallocAllocator<uint32_t>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<uint32_t>(i));
+        }
+        // Значение берётся из буфера, который переезжает при росте
+        while (v.Size() != v.Capacity()) {
+            v.PushBack(0);
+        }
+        v.PushBack(v[1]);
+        v.Insert(v.begin() + 1, v[SIZE - 1]);
+        v.Reserve(v.Capacity() * 4);
+        assert(v[0] == 0);
+        assert(v[1] == SIZE - 1);
+        assert(v[2] == 1);
+        assert(v[SIZE] == SIZE - 1);
+        assert(v[v.Size() - 1] == 1);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj, ExpandableAllocator<Obj>> v;
+        v.EmplaceBack(1);
+        const Obj* const first = &v[0];
+        v.Reserve(10);
+        v.EmplaceBack(2);
+        v.Emplace(v.begin(), 3);
+        assert(&v[0] == first);
+        assert(v.Capacity() == 10);
+        assert(v[0].id == 3);
+        assert(v[1].id == 1);
+        assert(v[2].id == 2);
+        v.Reserve(100);
+        assert(v.Capacity() == 100);
+        assert(&v[0] != first);
+        assert(Obj::num_copied == 0);
     }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
 
-    inline static size_t def_ctor = 0;
-    inline static size_t copy_ctor = 0;
-    inline static size_t move_ctor = 0;
-    inline static size_t copy_assign = 0;
-    inline static size_t move_assign = 0;
-    inline static size_t dtor = 0;
-};
+void Test11() {
+    const size_t SIZE = 1000;
+    static_assert(DoublingGrowth::NextCapacity(0, 1, 4) == 1);
+    static_assert(DoublingGrowth::NextCapacity(8, 9, 4) == 16);
+    static_assert(GoldenGrowth::NextCapacity(8, 9, 4) == 12);
+    static_assert(GoldenGrowth::NextCapacity(1, 2, 4) == 2);
+    static_assert(PageRoundedGrowth<>::NextCapacity(0, 3, 4) == 4);
+    static_assert(PageRoundedGrowth<>::NextCapacity(1000, 1001, 4) == 2048);
+    static_assert(PageRoundedGrowth<>::NextCapacity(1500, 1501, 3) == 4096);
+    static_assert(CappedLinearGrowth<4096>::NextCapacity(256, 257, 4) == 512);
+    static_assert(CappedLinearGrowth<4096>::NextCapacity(2048, 2049, 4) == 3072);
+    static_assert(CappedLinearGrowth<4096>::NextCapacity(2048, 10000, 4) == 10000);
+    {
+        Vector<int, std::allocator<int>, GoldenGrowth> v;
+        size_t capacity = 0;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+            if (v.Capacity() != capacity) {
+                assert(capacity == 0 || v.Capacity() == std::max<size_t>(capacity + capacity / 2, capacity + 1));
+                capacity = v.Capacity();
+            }
+        }
+        // Resize и Emplace растут по одной и той же политике
+        Vector<int, std::allocator<int>, GoldenGrowth> w(SIZE);
+        w.Resize(SIZE + 1);
+        assert(w.Capacity() == SIZE + SIZE / 2);
+        w.Resize(SIZE * 4);
+        assert(w.Capacity() == SIZE * 4);
+        w.Reserve(SIZE * 4 + 1);
+        assert(w.Capacity() == SIZE * 4 + 1);
+    }
+    {
+        Vector<char, MallocAllocator<char>, PageRoundedGrowth<>> v;
+        for (size_t i = 0; i < 3 * SIZE; ++i) {
+            v.PushBack(static_cast<char>(i));
+        }
+        assert(v.Capacity() >= 4096);
+        assert(v[SIZE] == static_cast<char>(SIZE));
+    }
+    {
+        Vector<uint64_t, std::allocator<uint64_t>, CappedLinearGrowth<1024>> v(128);
+        v.PushBack(1);
+        assert(v.Capacity() == 256);
+        v.Resize(v.Capacity() + 1);
+        assert(v.Capacity() == 256 + 128);
+    }
+    {
+        Vector<int> v;
+        try {
+            v.Reserve(v.MaxSize() + 1);
+            assert(false && "Exception is expected");
+        } catch (const std::length_error&) {
+        }
+        assert(v.Capacity() == 0);
+    }
+}
+
+void Test12() {
+    using namespace std::literals;
+    const size_t N = 8;
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, N> v;
+        for (size_t i = 0; i < N; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        assert(v.IsInline());
+        assert(v.Capacity() == N);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(N));
+        // Собственный элемент остаётся корректным при переходе в кучу
+        v.PushBack(v[0]);
+        assert(!v.IsInline());
+        assert(v.Capacity() == N * 2);
+        assert(v[N].id == 0);
+        v.Insert(v.cbegin() + 1, Obj{42, "Ivan"s});
+        v.Erase(v.cbegin() + 2);
+        assert(v[1].id == 42);
+        assert(v[2].id == 2);
+        assert(v.Size() == N + 1);
+        assert(Obj::num_copied == 1);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(N + 1));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, N> v_inline(N / 2);
+        SmallVector<Obj, N> v_heap(N * 2);
+        v_inline[0].id = 1;
+        v_heap[0].id = 2;
+        v_inline.Swap(v_heap);
+        assert(v_inline.Size() == N * 2 && !v_inline.IsInline());
+        assert(v_heap.Size() == N / 2 && v_heap.IsInline());
+        assert(v_inline[0].id == 2);
+        assert(v_heap[0].id == 1);
+
+        SmallVector<Obj, N> v_moved(std::move(v_inline));
+        assert(v_moved.Size() == N * 2);
+        assert(v_inline.Size() == 0);
+        SmallVector<Obj, N> v_copy(v_moved);
+        v_copy = v_heap;
+        assert(v_copy.Size() == N / 2);
+        v_copy.Resize(N * 4);
+        assert(v_copy.Capacity() == N * 4);
+        v_copy.Reserve(N * 5);
+        assert(v_copy[0].id == 1);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(N * 2 + N / 2 + N * 4));
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Гарантии безопасности исключений те же, что проверяет Test2
+        Obj::ResetCounters();
+        Obj::default_construction_throw_countdown = N;
+        try {
+            SmallVector<Obj, N> v(N * 2);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
 
-void Dump() {
-    using namespace std;
-    cerr << "Def ctors: "sv << C::def_ctor              //
-    << ", Copy ctors: "sv << C::copy_ctor          //
-    << ", Move ctors: "sv << C::move_ctor          //
-    << ", Copy assignments: "sv << C::copy_assign  //
-    << ", Move assignments: "sv << C::move_assign  //
-    << ", Dtors: "sv << C::dtor << endl;
+        Obj::ResetCounters();
+        SmallVector<Obj, N> v(N);
+        v[N / 2].throw_on_copy = true;
+        try {
+            SmallVector<Obj, N> v_copy(v);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+            assert(Obj::num_copied == N / 2);
+        }
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(N));
+        v.Reserve(N * 2);
+        assert(v.Size() == N);
+        assert(Obj::num_moved == static_cast<int>(N));
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(N));
+    }
+    {
+        SmallVector<std::unique_ptr<int>, 2> v;
+        v.PushBack(std::make_unique<int>(1));
+        v.PushBack(std::make_unique<int>(2));
+        v.Insert(v.cbegin(), std::make_unique<int>(0));
+        auto v_moved = std::move(v);
+        assert(v_moved.Size() == 3);
+        assert(*v_moved[0] == 0 && *v_moved[2] == 2);
+    }
 }
 
-void Benchmark() {
-    using namespace std;
-    try {
-        const size_t NUM = 10;
-        C c;
-        {
-            cerr << "std::vector:"sv << endl;
-            C::Reset();
-            vector<C> v(NUM);
-            Dump();
-            v.push_back(c);
+void Test13() {
+    const size_t SIZE = 10;
+    {
+        // Вставка диапазона в пределах вместимости сдвигает хвост один раз
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        std::vector<Obj> src;
+        for (int i = 1; i <= 3; ++i) {
+            src.emplace_back(i);
         }
-        Dump();
-    } catch (...) {
+        Obj::ResetCounters();
+        auto pos = v.Insert(v.cbegin() + 2, src.begin(), src.end());
+        assert(pos == v.begin() + 2);
+        assert(v.Size() == SIZE + 3);
+        assert(v[2].id == 1 && v[4].id == 3 && v[5].id == 0);
+        assert(Obj::num_copied + Obj::num_assigned == 3);
+        assert(Obj::num_moved + Obj::num_move_assigned == static_cast<int>(SIZE) - 2);
+
+        // При нехватке вместимости буфер выделяется один раз
+        Obj::ResetCounters();
+        v.Insert(v.cbegin() + 1, src.begin(), src.end());
+        v.Insert(v.cbegin() + 1, SIZE * 2, src[0]);
+        assert(v.Size() == SIZE * 3 + 6);
+        assert(v.Capacity() == SIZE * 4);
+        assert(v[1].id == 1 && v[SIZE * 2 + 1].id == 1 && v[SIZE * 2 + 3].id == 3);
+        assert(Obj::num_copied + Obj::num_assigned == static_cast<int>(SIZE) * 2 + 3 + 1);
     }
-    try {
-        const size_t NUM = 10;
-        C c;
+    {
+        Vector<int> v;
+        v.Append(std::list<int>{1, 2, 3});
+        v.Insert(v.cbegin() + 1, 2, v[2]);
+        v.Append(v);
+        assert((std::vector<int>(v.begin(), v.end()) == std::vector<int>{1, 3, 3, 2, 3, 1, 3, 3, 2, 3}));
+
+        std::istringstream input("7 8 9");
+        v.Insert(v.cbegin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(v.Size() == 13);
+        assert(v[0] == 1 && v[1] == 7 && v[3] == 9 && v[4] == 3);
+
+        const int values[] = {4, 5};
+        v.Assign(std::begin(values), std::end(values));
+        assert(v.Size() == 2 && v[0] == 4 && v[1] == 5);
+        std::istringstream more("6 7 8");
+        v.Assign(std::istream_iterator<int>(more), std::istream_iterator<int>());
+        assert(v.Size() == 3 && v[2] == 8);
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        v.PushBack(std::make_unique<int>(0));
+        v.PushBack(std::make_unique<int>(3));
+        std::vector<std::unique_ptr<int>> src;
+        src.push_back(std::make_unique<int>(1));
+        src.push_back(std::make_unique<int>(2));
+        v.Insert(v.cbegin() + 1, std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()));
+        assert(v.Size() == 4);
+        assert(*v[0] == 0 && *v[1] == 1 && *v[2] == 2 && *v[3] == 3);
+    }
+    {
+        // Если копирование выбросит исключение при перевыделении, вектор не меняется
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        Vector<Obj> src(3);
+        src[2].throw_on_copy = true;
+        try {
+            v.Insert(v.cbegin() + 1, src.begin(), src.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == SIZE);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE) + 3);
+    }
+}
+
+void Test14() {
+    using namespace std::literals;
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v;
+        v.ResizeDefaultInit(SIZE);
+        assert(v.Size() == SIZE);
+        assert(Obj::num_default_constructed == SIZE);
+        v.ResizeDefaultInit(SIZE / 2);
+        assert(v.Size() == SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == SIZE / 2);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<char> v;
+        v.ResizeDefaultInit(4);
+        std::memcpy(v.begin(), "head", 4);
+        const std::string_view payload = "payload of a recv() call"sv;
+        v.ResizeAndOverwrite(v.Size() + SIZE, [&](char* data, size_t count) {
+            assert(count == 4 + SIZE);
+            std::memcpy(data + 4, payload.data(), payload.size());
+            return 4 + payload.size();
+        });
+        assert(v.Size() == 4 + payload.size());
+        assert(v.Capacity() >= 4 + SIZE);
+        assert(std::string_view(v.begin(), v.Size()) == "head"s + std::string(payload));
+
+        // Если операция выбросит исключение, прежний размер сохраняется
+        try {
+            v.ResizeAndOverwrite(SIZE * 10, [](char*, size_t) -> size_t {
+                throw std::runtime_error("Oops");
+            });
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 4 + payload.size());
+        assert(v[0] == 'h');
+    }
+    {
+        // polymorphic_allocator не заполняет нулями буфер тривиальных элементов
+        std::byte buffer[1024];
+        std::memset(buffer, 'x', sizeof(buffer));
+        std::pmr::monotonic_buffer_resource resource(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        pmr::Vector<char> v(&resource);
+        v.ResizeDefaultInit(SIZE);
+        assert(v.Size() == SIZE && v.begin() >= reinterpret_cast<char*>(buffer));
+        assert(std::count(v.begin(), v.end(), 'x') == static_cast<std::ptrdiff_t>(SIZE));
+
+        // Элементы, использующие аллокатор, по-прежнему получают ресурс вектора
+        std::pmr::unsynchronized_pool_resource pool;
+        pmr::Vector<std::pmr::string> strings(&pool);
+        strings.ResizeDefaultInit(3);
+        assert(strings.Size() == 3 && strings[2].empty() && strings[2].get_allocator().resource() == &pool);
+    }
+}
+
+void Test15() {
+    const size_t SIZE = 10;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+        auto pos = v.Erase(v.cbegin() + 2, v.cbegin() + 5);
+        assert(pos == v.begin() + 2);
+        assert(v.Size() == SIZE - 3);
+        assert(v[2].id == 5);
+        assert(Obj::num_move_assigned == static_cast<int>(SIZE) - 5);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE) - 3);
+
+        Obj::ResetCounters();
+        const size_t removed = EraseIf(v, [](const Obj& obj) {
+            return obj.id % 2 == 1;
+        });
+        assert(removed == 4);
+        assert(v.Size() == 3);
+        assert(v[0].id == 0 && v[1].id == 6 && v[2].id == 8);
+        assert(Obj::num_destroyed == 4);
+
+        pos = v.SwapAndPop(v.cbegin());
+        assert(v.Size() == 2);
+        assert(pos->id == 8);
+        assert(v[1].id == 6);
+        v.SwapAndPop(v.cbegin() + 1);
+        assert(v.Size() == 1 && v[0].id == 8);
+        assert(v.Erase(v.cbegin(), v.cbegin()) == v.begin());
+    }
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(std::make_unique<int>(static_cast<int>(i)));
+        }
+        v.Erase(v.cbegin(), v.cbegin() + 3);
+        v.SwapAndPop(v.cbegin());
+        assert(v.Size() == SIZE - 4);
+        assert(*v[0] == static_cast<int>(SIZE - 1));
+        assert(*v[1] == 4);
+        EraseIf(v, [](const std::unique_ptr<int>& p) {
+            return *p > 5;
+        });
+        assert(v.Size() == 2);
+        assert(*v[0] == 4 && *v[1] == 5);
+    }
+}
+
+void Test16() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Resize(SIZE / 10);
+        assert(v.Capacity() == SIZE);
+        v.ShrinkToFit();
+        assert(v.Capacity() == SIZE / 10);
+        assert(v.Size() == SIZE / 10);
+        assert(Obj::num_moved == static_cast<int>(SIZE / 10));
+        v.Reserve(SIZE);
+        v.ShrinkTo(SIZE / 2);
+        assert(v.Capacity() == SIZE / 2);
+        v.ShrinkTo(0);
+        assert(v.Capacity() == SIZE / 10);
+        v.Clear(false);
+        assert(v.Size() == 0 && v.Capacity() == SIZE / 10);
+        v.PushBack(Obj{1});
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Копирование выбрасывает исключение: вместимость и элементы сохраняются
+        Obj::ResetCounters();
+        struct ThrowingMove : Obj {
+            using Obj::Obj;
+            ThrowingMove(const ThrowingMove&) = default;
+            ThrowingMove(ThrowingMove&& other) noexcept(false)
+            : Obj(other)  //
+            {
+            }
+        };
+        Vector<ThrowingMove> v(SIZE);
+        v.Resize(SIZE / 2);
+        v[SIZE / 4].throw_on_copy = true;
+        try {
+            v.ShrinkToFit();
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Capacity() == SIZE);
+        assert(v.Size() == SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == static_cast<int>(SIZE / 2));
+    }
+    {
+        Vector<int, MallocAllocator<int>> v(SIZE);
+        v[1] = 42;
+        v.Resize(2);
+        v.ShrinkToFit();
+        assert(v.Capacity() >= 2 && v.Capacity() < SIZE);
+        assert(v[1] == 42);
+    }
+}
+
+void Test17() {
+    // Статистика не меняет размер контейнеров
+    static_assert(sizeof(Vector<int>) == sizeof(int*) + 2 * sizeof(size_t));
+    static_assert(sizeof(RawMemory<int>) == sizeof(int*) + sizeof(size_t));
+    static_assert(std::is_empty_v<detail::StatsHooks<int>>);
+    if constexpr (!VECTOR_STATS_ENABLED) {
+        // Точки сбора не обращаются к счётчикам, и ни один тег не зарегистрирован
+        Vector<StatsPoint> v;
+        for (int i = 0; i < 5; ++i) {
+            v.PushBack(StatsPoint{i, i});
+        }
+        v.ShrinkToFit();
+        size_t num_tags = 0;
+        VectorStatsRegistry::Instance().ForEach([&num_tags](std::string_view, const VectorStats&) {
+            ++num_tags;
+        });
+        assert(num_tags == 0);
+        return;
+    }
+    {
+        VectorStats& stats = GetVectorStats<StatsPoint>();
+        stats.Reset();
         {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            Dump();
-            v.PushBack(c);
+            Vector<StatsPoint> v;
+            for (int i = 0; i < 5; ++i) {
+                v.PushBack(StatsPoint{i, i});
+            }
+            // Вместимость растёт 1, 2, 4, 8
+            assert(stats.allocations == 4);
+            assert(stats.deallocations == 3);
+            assert(stats.reallocations == 3);
+            assert(stats.bytes_relocated == 7 * sizeof(StatsPoint));
+            assert(stats.bytes_moved == 0 && stats.bytes_copied == 0);
+            assert(stats.wasted_capacity_bytes == 4 * sizeof(StatsPoint));
+            assert(stats.capacity_bytes == 8 * sizeof(StatsPoint));
+            // При переезде 4 -> 8 живы оба буфера
+            assert(stats.peak_capacity_bytes == 12 * sizeof(StatsPoint));
         }
-        Dump();
-    } catch (...) {
+        assert(stats.deallocations == 4);
+        assert(stats.capacity_bytes == 0);
+    }
+    {
+        // Obj перемещается без исключений, ThrowingMove при переезде копируется
+        struct ThrowingMove : Obj {
+            using Obj::Obj;
+            ThrowingMove(const ThrowingMove&) = default;
+            ThrowingMove(ThrowingMove&& other) noexcept(false)
+            : Obj(other)  //
+            {
+            }
+        };
+        GetVectorStats<Obj>().Reset();
+        GetVectorStats<ThrowingMove>().Reset();
+        Vector<Obj> moved(4);
+        moved.Reserve(8);
+        Vector<ThrowingMove> copied(4);
+        copied.Reserve(8);
+        assert(GetVectorStats<Obj>().bytes_moved == 4 * sizeof(Obj));
+        assert(GetVectorStats<Obj>().bytes_copied == 0);
+        assert(GetVectorStats<ThrowingMove>().bytes_copied == 4 * sizeof(ThrowingMove));
+        assert(GetVectorStats<ThrowingMove>().bytes_moved == 0);
+    }
+    {
+        VectorStats& stats = GetVectorStats<int>();
+        stats.Reset();
+        Vector<int, ExpandableAllocator<int>> v;
+        v.Reserve(2);
+        v.Reserve(16);
+        assert(stats.in_place_growths == 1);
+        assert(stats.reallocations == 0);
+        assert(stats.capacity_bytes == 16 * sizeof(int));
+        v.Reserve(100);
+        assert(stats.in_place_growths == 1);
+        assert(stats.reallocations == 1);
+    }
+    {
+        // Типы с общим тегом пишут в одни счётчики
+        GetVectorStats<StatsKeyGroup>().Reset();
+        Vector<StatsKeyA> a(1);
+        Vector<StatsKeyB> b(2);
+        assert(GetVectorStats<StatsKeyGroup>().allocations == 2);
+
+        size_t num_tags = 0;
+        bool has_group = false;
+        VectorStatsRegistry::Instance().ForEach([&](std::string_view name, const VectorStats& stats) {
+            ++num_tags;
+            if (name == typeid(StatsKeyGroup).name()) {
+                has_group = true;
+                assert(stats.capacity_bytes == 3 * sizeof(int));
+            }
+        });
+        assert(has_group && num_tags >= 4);
+    }
+}
+
+// Сравнивает алгоритмы vector_algorithms.h с алгоритмами стандартной библиотеки
+// на диапазонах всех длин, покрывающих и векторную часть, и хвост
+template <typename T>
+void CheckAlgorithms() {
+    for (size_t size = 0; size <= 70; ++size) {
+        Vector<T> v(size);
+        for (size_t i = 0; i < size; ++i) {
+            v[i] = static_cast<T>((i * 7919) % 23) - static_cast<T>(11);
+        }
+        for (int value = -12; value <= 12; ++value) {
+            const T x = static_cast<T>(value);
+            assert(Find(v, x) == std::find(v.begin(), v.end(), x));
+            assert(Count(v, x) == static_cast<size_t>(std::count(v.begin(), v.end(), x)));
+        }
+        if (size != 0) {
+            assert(Min(v) == *std::min_element(v.begin(), v.end()));
+            assert(Max(v) == *std::max_element(v.begin(), v.end()));
+            // Значения целые и малы, поэтому сумма точна в любом порядке сложения
+            assert(Sum(v) == std::accumulate(v.begin(), v.end(), detail::simd::SumType<T>{}));
+        }
+        Vector<T> copy(v);
+        assert(Equal(v, copy));
+        if (size != 0) {
+            copy[size - 1] = static_cast<T>(100);
+            assert(!Equal(v, copy));
+        }
+        Fill(copy, static_cast<T>(5));
+        assert(Count(copy, static_cast<T>(5)) == size);
+    }
+}
+
+void Test18() {
+    CheckAlgorithms<int32_t>();
+    CheckAlgorithms<float>();
+    CheckAlgorithms<double>();
+    CheckAlgorithms<int64_t>();
+    {
+        // Сумма int32_t не переполняется
+        Vector<int32_t> v(100);
+        Fill(v, std::numeric_limits<int32_t>::max());
+        assert(Sum(v) == int64_t{100} * std::numeric_limits<int32_t>::max());
+        v[37] = std::numeric_limits<int32_t>::min();
+        assert(Min(v) == std::numeric_limits<int32_t>::min());
+        assert(Find(v, std::numeric_limits<int32_t>::min()) == v.begin() + 37);
+    }
+    {
+        // NaN не равен ничему, -0 равен 0
+        Vector<float> v(20);
+        v[3] = std::numeric_limits<float>::quiet_NaN();
+        v[9] = -0.0f;
+        assert(Count(v, std::numeric_limits<float>::quiet_NaN()) == 0);
+        assert(Count(v, 0.0f) == 19);
+        assert(!Equal(v, v));
+    }
+    {
+        // Алгоритмы принимают и другие непрерывные диапазоны
+        SmallVector<int32_t, 16> small;
+        std::vector<std::string> strings{"a", "b", "c"};
+        for (int i = 0; i < 10; ++i) {
+            small.PushBack(i);
+        }
+        assert(Sum(small) == 45);
+        assert(*Find(strings, "b") == "b");
+        assert(Max(strings) == "c");
+    }
+}
+
+void Test19() {
+    const auto is_aligned = [](const void* p, size_t alignment) {
+        return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+    };
+    {
+        using Allocator = AlignedAllocator<float, 64>;
+        Vector<float, Allocator> v;
+        static_assert(decltype(v)::ALIGNMENT == 64);
+        static_assert(sizeof(v) == sizeof(Vector<float>));
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(is_aligned(v.begin(), 64));
+        }
+        assert(v.AssumeAligned() == v.begin());
+        float sum = 0;
+        const float* data = v.AssumeAligned();
+        for (size_t i = 0; i < v.Size(); ++i) {
+            sum += data[i];
+        }
+        assert(sum == 4950.0f);
+
+        // Большие буферы выравниваются по странице
+        Vector<float, Allocator> big(Allocator::PAGE_SIZE * 16);
+        assert(is_aligned(big.begin(), Allocator::PAGE_SIZE));
+    }
+    {
+        // Выравнивание типа сильнее запрошенного у аллокатора
+        struct alignas(128) Wide {
+            char bytes[128];
+        };
+        static_assert(Vector<Wide, AlignedAllocator<Wide, 16>>::ALIGNMENT == 128);
+        static_assert(Vector<Wide>::ALIGNMENT == 128);
+        Vector<Wide, AlignedAllocator<Wide, 16>> v(3);
+        Vector<Wide> plain(3);
+        assert(is_aligned(v.begin(), 128) && is_aligned(plain.begin(), 128));
+    }
+    {
+        // Перепривязанный аллокатор сохраняет выравнивание
+        using Rebound = std::allocator_traits<AlignedAllocator<int, 256>>::rebind_alloc<double>;
+        static_assert(std::is_same_v<Rebound, AlignedAllocator<double, 256>>);
+        SmallVector<int, 2, AlignedAllocator<int, 256>> small;
+        for (int i = 0; i < 10; ++i) {
+            small.PushBack(i);
+        }
+        assert(!small.IsInline() && is_aligned(small.begin(), 256));
+    }
+}
+
+void Test20() {
+    ThreadPool pool(3);
+    assert(pool.Concurrency() == 4);
+    const size_t SIZE = 1'000'003;
+    {
+        Vector<int64_t> v(SIZE);
+        ParallelForEach(v, [](int64_t& x) {
+            ++x;
+        }, pool);
+        assert(Count(v, 1) == SIZE);
+
+        Vector<int64_t> squares(SIZE);
+        std::iota(v.begin(), v.end(), 0);
+        ParallelTransform(v, squares, [](int64_t x) {
+            return x * x;
+        }, pool);
+        for (size_t i = 0; i < SIZE; i += 9973) {
+            assert(squares[i] == static_cast<int64_t>(i * i));
+        }
+
+        const int64_t expected = static_cast<int64_t>(SIZE) * (SIZE - 1) / 2;
+        assert(ParallelReduce(v, int64_t{0}, std::plus<>{}, pool) == expected);
+        assert(ParallelReduce(v, int64_t{10}) == expected + 10);
+        assert(ParallelReduce(Vector<int64_t>{}, int64_t{7}, std::plus<>{}, pool) == 7);
+    }
+    {
+        std::mt19937 gen(42);
+        Vector<uint32_t> v(SIZE);
+        for (uint32_t& x : v) {
+            x = gen();
+        }
+        std::vector<uint32_t> expected(v.begin(), v.end());
+        std::sort(expected.begin(), expected.end());
+        ParallelSort(v, std::less<>{}, pool);
+        assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+        ParallelSort(v, std::greater<>{});
+        assert(std::is_sorted(v.begin(), v.end(), std::greater<>{}));
+
+        std::vector<std::string> strings;
+        for (int i = 0; i < 50'000; ++i) {
+            strings.push_back(std::to_string(gen()));
+        }
+        ParallelSort(strings, std::less<>{}, pool);
+        assert(std::is_sorted(strings.begin(), strings.end()));
+    }
+    {
+        // Исключение задачи доходит до вызвавшего, пул остаётся работоспособным
+        Vector<int> v(SIZE);
+        v[SIZE / 2] = 1;
+        try {
+            ParallelForEach(v, [](int x) {
+                if (x == 1) {
+                    throw std::runtime_error("element");
+                }
+            }, pool);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        // Вложенный вызов выполняется в потоке задачи
+        std::atomic<int> total = 0;
+        pool.Run(8, [&](size_t) {
+            pool.Run(4, [&](size_t) {
+                ++total;
+            });
+        });
+        assert(total == 32);
+    }
+    {
+        Vector<int> v(3);
+        v[0] = 5;
+        ParallelResize(v, SIZE, pool);
+        assert(v.Size() == SIZE && v[0] == 5 && Count(v, 0) == SIZE - 1);
+        ParallelResize(v, 1, pool);
+        assert(v.Size() == 1 && v[0] == 5);
+
+        Vector<std::string> strings(1);
+        ParallelResize(strings, 100, pool);
+        assert(strings.Size() == 100 && strings[99].empty());
+    }
+}
+
+void Test21() {
+    using Layout = detail::SegmentLayout<2>;
+    static_assert(Layout::Locate(0).segment == 0 && Layout::Locate(3).offset == 3);
+    static_assert(Layout::Locate(4).segment == 1 && Layout::Locate(4).offset == 0);
+    static_assert(Layout::Locate(11).segment == 1 && Layout::Locate(11).offset == 7);
+    static_assert(Layout::Locate(12).segment == 2 && Layout::SegmentStart(2) == 12);
+    static_assert(Layout::SegmentsFor(0) == 0 && Layout::SegmentsFor(12) == 2 && Layout::SegmentsFor(13) == 3);
+    static_assert(Layout::Locate(Layout::MAX_SIZE - 1).segment == Layout::MAX_SEGMENTS - 1);
+    {
+        struct Event {
+            size_t thread;
+            size_t seq;
+        };
+        const size_t NUM_THREADS = 4;
+        const size_t NUM_EVENTS = 50'000;
+        ConcurrentVector<Event> events;
+        const size_t first = events.PushBack(Event{NUM_THREADS, 0});
+        const Event* first_address = &events[first];
+
+        std::atomic<bool> stop_reader = false;
+        std::thread reader([&] {
+            // Готовые элементы читаются, пока писатели добавляют новые
+            while (!stop_reader) {
+                for (size_t i = 0; i < events.Size(); i += 97) {
+                    if (events.IsReady(i)) {
+                        assert(events[i].thread <= NUM_THREADS);
+                    }
+                }
+            }
+        });
+        std::vector<std::thread> writers;
+        for (size_t t = 0; t < NUM_THREADS; ++t) {
+            writers.emplace_back([&events, t] {
+                for (size_t seq = 0; seq < NUM_EVENTS; ++seq) {
+                    const size_t index = events.EmplaceBack(Event{t, seq});
+                    assert(events[index].thread == t && events[index].seq == seq);
+                }
+            });
+        }
+        for (std::thread& writer : writers) {
+            writer.join();
+        }
+        stop_reader = true;
+        reader.join();
+
+        assert(events.Size() == NUM_THREADS * NUM_EVENTS + 1);
+        assert(&events[first] == first_address);
+        std::vector<size_t> next_seq(NUM_THREADS);
+        for (size_t i = 1; i < events.Size(); ++i) {
+            assert(events.IsReady(i));
+            // События одного потока идут в порядке добавления
+            const Event& event = events[i];
+            assert(event.seq == next_seq[event.thread]++);
+        }
+        assert(!events.IsReady(events.Size()));
+    }
+    {
+        Obj::ResetCounters();
+        {
+            ConcurrentVector<Obj> v;
+            v.Reserve(100);
+            v.EmplaceBack(1);
+            Obj throwing(2);
+            throwing.throw_on_copy = true;
+            try {
+                v.PushBack(throwing);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            v.EmplaceBack(3);
+            assert(v.Size() == 3);
+            assert(v.IsReady(0) && !v.IsReady(1) && v.IsReady(2));
+            assert(v[2].id == 3);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test22() {
+    static_assert(std::random_access_iterator<SegmentedVector<int>::iterator>);
+    static_assert(std::random_access_iterator<SegmentedVector<int>::const_iterator>);
+    static_assert(std::is_convertible_v<SegmentedVector<int>::iterator, SegmentedVector<int>::const_iterator>);
+    const size_t SIZE = 10'000;
+    {
+        Obj::ResetCounters();
+        SegmentedVector<Obj> v;
+        v.EmplaceBack(0);
+        const Obj* first = &v[0];
+        for (size_t i = 1; i < SIZE; ++i) {
+            // Элемент самого вектора: при росте он не переезжает
+            v.PushBack(v[i - 1]);
+            v[i].id = static_cast<int>(i);
+        }
+        assert(&v[0] == first);
+        assert(Obj::num_moved == 0);
+        assert(Obj::num_copied == static_cast<int>(SIZE - 1));
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i].id == static_cast<int>(i));
+        }
+
+        SegmentedVector<Obj> copy(v);
+        assert(copy.Size() == SIZE && copy[SIZE - 1].id == static_cast<int>(SIZE - 1));
+        copy.Resize(10);
+        assert(copy.Size() == 10);
+        v = copy;
+        assert(v.Size() == 10 && v[9].id == 9);
+        SegmentedVector<Obj> moved(std::move(v));
+        assert(moved.Size() == 10 && v.Size() == 0);
+        moved.PopBack();
+        assert(moved.Size() == 9);
+        moved.Clear();
+        assert(moved.Capacity() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Исключение при создании элементов Resize откатывает размер
+        Obj::ResetCounters();
+        SegmentedVector<Obj> v(5);
+        Obj::default_construction_throw_countdown = 3;
+        try {
+            v.Resize(50);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        Obj::default_construction_throw_countdown = 0;
+        assert(v.Size() == 5);
+        assert(Obj::GetAliveObjectCount() == 5);
+    }
+    {
+        SegmentedVector<int> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(1000 - i);
+        }
+        std::sort(v.begin(), v.end());
+        assert(std::is_sorted(v.cbegin(), v.cend()));
+        assert(std::accumulate(v.begin(), v.end(), 0) == 500500);
+        assert(v.end() - v.begin() == 1000);
+        assert(*(v.begin() + 500) == 501);
+    }
+    {
+        // Таблица сегментов и сами сегменты выделяются из ресурса вектора
+        std::pmr::unsynchronized_pool_resource pool;
+        std::pmr::monotonic_buffer_resource arena;
+        SegmentedVector<std::pmr::string, std::pmr::polymorphic_allocator<std::pmr::string>> v(&pool);
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(std::pmr::string(std::to_string(i) + " long enough to leave the inline buffer"));
+        }
+        assert(v.Size() == 100 && v[99].get_allocator().resource() == &pool);
+        SegmentedVector<std::pmr::string, std::pmr::polymorphic_allocator<std::pmr::string>> other(&arena);
+        other = v;
+        assert(other.GetAllocator().resource() == &arena);
+        assert(other.Size() == 100 && other[42] == v[42] && other[42].get_allocator().resource() == &arena);
+        other = std::move(v);
+        assert(other.GetAllocator().resource() == &arena && other.Size() == 100);
+        other.PopBack();
+        SegmentedVector<int, std::pmr::polymorphic_allocator<int>> ints(&pool);
+        ints.PushBack(1);
+        assert(ints.Size() == 1 && ints[0] == 1);
+    }
+    {
+        // Распространяемый аллокатор переходит вместе с памятью
+        ArenaStats stats1;
+        ArenaStats stats2;
+        {
+            using Alloc = ArenaAllocator<int>;
+            SegmentedVector<int, Alloc> v1(100, Alloc{&stats1});
+            SegmentedVector<int, Alloc> v2(10, Alloc{&stats2});
+            v2 = v1;
+            assert(v2.GetAllocator().stats == &stats1 && v2.Size() == 100);
+            SegmentedVector<int, Alloc> v3(1, Alloc{&stats2});
+            v3 = std::move(v1);
+            assert(v3.GetAllocator().stats == &stats1 && v3.Size() == 100);
+            // Память, выделенная до присваиваний, вернулась прежней арене
+            assert(stats2.allocations == stats2.deallocations);
+            v3.Swap(v2);
+            assert(v3.Size() == 100 && v2.Size() == 100);
+        }
+        assert(stats1.allocations == stats1.deallocations);
+        assert(stats2.allocations == stats2.deallocations);
+    }
+    {
+        // Нераспространяемый аллокатор остаётся на месте, элементы копируются и перемещаются по одному
+        ArenaStats stats1;
+        ArenaStats stats2;
+        {
+            using Alloc = ArenaAllocator<Obj, false>;
+            Obj::ResetCounters();
+            SegmentedVector<Obj, Alloc> v1(100, Alloc{&stats1});
+            SegmentedVector<Obj, Alloc> v2(Alloc{&stats2});
+            v2 = v1;
+            assert(v2.GetAllocator().stats == &stats2 && v2.Size() == 100);
+            assert(Obj::num_copied == 100);
+            SegmentedVector<Obj, Alloc> v3(Alloc{&stats2});
+            v3 = std::move(v1);
+            assert(v3.GetAllocator().stats == &stats2 && v3.Size() == 100);
+            assert(Obj::num_moved == 100);
+        }
+        assert(stats1.allocations == stats1.deallocations);
+        assert(stats2.allocations == stats2.deallocations);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test23() {
+    {
+        SoAVector<int, std::string, double> v;
+        static_assert(decltype(v)::NUM_COLUMNS == 3);
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i, std::to_string(i), i * 0.5);
+        }
+        assert(v.Size() == 100 && v.Capacity() == 128);
+        const auto [id, name, weight] = v[42];
+        assert(id == 42 && name == "42" && weight == 21.0);
+        std::get<1>(v[42]) = "answer";
+        assert(v.Column<1>()[42] == "answer");
+
+        std::span<int> ids = v.Column<0>();
+        assert(ids.size() == 100 && std::accumulate(ids.begin(), ids.end(), 0) == 4950);
+        assert(Sum(v.Column<0>()) == 4950);
+
+        // Аргументы ссылаются на строку самого вектора, который при этом растёт
+        v.Resize(128);
+        v.EmplaceBack(std::get<0>(v[42]), std::get<1>(v[42]), std::get<2>(v[42]));
+        assert(v.Capacity() == 256 && std::get<1>(v[128]) == "answer");
+
+        int rows = 0;
+        for (auto [row_id, row_name, row_weight] : v) {
+            row_id += 1;
+            ++rows;
+        }
+        assert(rows == 129 && std::get<0>(v[0]) == 1);
+
+        const auto copy = v;
+        assert(copy.Size() == 129 && std::get<1>(copy[128]) == "answer");
+        v.PopBack();
+        v.Resize(10);
+        assert(v.Size() == 10 && std::get<1>(v[9]) == "9");
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == 0);
+    }
+    {
+        // Ошибка при создании поля строки разрушает уже созданные поля
+        Obj::ResetCounters();
+        SoAVector<Obj, Obj> v;
+        v.Reserve(4);
+        v.EmplaceBack(1, 2);
+        Obj throwing(3);
+        throwing.throw_on_copy = true;
+        try {
+            v.EmplaceBack(4, throwing);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 1 && Obj::GetAliveObjectCount() == 3);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Столбец, который при переносе копируется, переносится первым: если копирование
+        // выбросит исключение, перемещаемые столбцы останутся нетронутыми
+        struct ThrowingMove : Obj {
+            using Obj::Obj;
+            ThrowingMove(const ThrowingMove&) = default;
+            ThrowingMove(ThrowingMove&& other) noexcept(false)
+            : Obj(other)  //
+            {
+            }
+        };
+        Obj::ResetCounters();
+        SoAVector<std::string, ThrowingMove> v;
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBack(std::string(32, 'a' + i), i);
+        }
+        std::get<1>(v[2]).throw_on_copy = true;
+        try {
+            v.EmplaceBack(std::string(32, 'z'), 4);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 4 && v.Capacity() == 4);
+        for (int i = 0; i < 4; ++i) {
+            assert(std::get<0>(v[i]) == std::string(32, 'a' + i));
+            assert(std::get<1>(v[i]).id == i);
+        }
+        assert(Obj::GetAliveObjectCount() == 4);
+    }
+}
+
+void Test24() {
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() / ("mapped_vector_test_" + std::to_string(::getpid()));
+    const size_t SIZE = 100'000;
+    {
+        auto v = MappedVector<uint64_t>::Create(path);
+        assert(v.Size() == 0);
+        for (uint64_t i = 0; i < SIZE; ++i) {
+            v.PushBack(i * i);
+        }
+        // Элемент самого вектора при переотображении
+        v.PushBack(v[0]);
+        v.PopBack();
+        assert(v.Capacity() >= SIZE);
+        v.Sync();
+    }
+    {
+        auto v = MappedVector<uint64_t>::Open(path);
+        assert(v.Size() == SIZE);
+        for (uint64_t i = 0; i < SIZE; i += 997) {
+            assert(v[i] == i * i);
+        }
+        v.Resize(SIZE * 3);
+        assert(v[SIZE * 2] == 0 && v[SIZE - 1] == (SIZE - 1) * (SIZE - 1));
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Capacity() < SIZE);
+    }
+    assert(std::filesystem::file_size(path) == 4096);
+    {
+        // Повторный рост после уменьшения заполняет элементы нулями
+        auto v = MappedVector<uint64_t>::Open(path);
+        assert(v.Size() == 10 && v[9] == 81);
+        v.Resize(20);
+        assert(v[15] == 0);
+    }
+    {
+        try {
+            auto v = MappedVector<uint32_t>::Open(path);
+            assert(false && "Exception is expected");
+        } catch (const std::invalid_argument&) {
+        }
+        std::ofstream(path, std::ios::trunc) << "not a vector";
+        try {
+            auto v = MappedVector<uint64_t>::Open(path);
+            assert(false && "Exception is expected");
+        } catch (const std::invalid_argument&) {
+        }
+        try {
+            auto v = MappedVector<uint64_t>::Open("/nonexistent-dir/vector");
+            assert(false && "Exception is expected");
+        } catch (const std::system_error&) {
+        }
+    }
+    std::filesystem::remove(path);
+    {
+        MappedVector<double> v;
+        auto huge = MappedVector<int>::Anonymous();
+        for (int i = 0; i < 5000; ++i) {
+            v.PushBack(i * 0.5);
+            huge.EmplaceBack(i);
+        }
+        assert(v.Size() == 5000 && v[4999] == 2499.5);
+        assert(Sum(huge) == 4999 * 5000 / 2);
+        MappedVector<double> moved(std::move(v));
+        assert(moved.Size() == 5000 && v.Size() == 0);
+    }
+}
+
+void Test25() {
+    {
+        Vector<int> v(3);
+        std::iota(v.begin(), v.end(), 1);
+        std::span<int> span = v.AsSpan();
+        span[1] = 20;
+        assert(v[1] == 20 && span.size() == 3);
+        assert(v.AsBytes().size() == 3 * sizeof(int));
+        assert(std::as_const(v).AsSpan().data() == v.begin());
+    }
+    {
+        Vector<int> v(100);
+        std::iota(v.begin(), v.end(), 0);
+        const size_t capacity = v.Capacity();
+        int* buffer = v.ReleaseBuffer();
+        assert(v.Size() == 0 && v.Capacity() == 0);
+        assert(buffer[99] == 99);
+
+        Vector<int> adopted(7);
+        adopted.AdoptBuffer(buffer, 100, capacity);
+        assert(adopted.Size() == 100 && adopted.Capacity() == capacity && adopted.begin() == buffer);
+        adopted.PushBack(100);
+        assert(adopted[100] == 100 && adopted[42] == 42);
+    }
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() / ("vector_io_test_" + std::to_string(::getpid()));
+    struct Pod {
+        uint32_t id;
+        float weight;
+    };
+    const size_t SIZE = 50'000;
+    {
+        Vector<Pod> v;
+        for (uint32_t i = 0; i < SIZE; ++i) {
+            v.PushBack({i, i * 0.25f});
+        }
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        assert(fd >= 0);
+        Serialize(fd, v);
+        Serialize(fd, Vector<Pod>{});
+        ::lseek(fd, 0, SEEK_SET);
+        Vector<Pod> read = Deserialize<Pod>(fd);
+        assert(read.Size() == SIZE && read[SIZE - 1].id == SIZE - 1 && read[4].weight == 1.0f);
+        assert(Deserialize<Pod>(fd).Size() == 0);
+        // Данные закончились
+        try {
+            Deserialize<Pod>(fd);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        ::lseek(fd, 0, SEEK_SET);
+        try {
+            Deserialize<uint64_t>(fd);
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+        ::close(fd);
+    }
+    {
+        // Заголовок обещает терабайты: память под них не выделяется ни для файла, ни для канала
+        const detail::SerializedHeader header = detail::SerializedHeader::For<Pod>(size_t{1} << 40);
+        const std::filesystem::path hostile_path = path.string() + "_hostile";
+        const int fd = ::open(hostile_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        assert(fd >= 0);
+        assert(::write(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header)));
+        ::lseek(fd, 0, SEEK_SET);
+        try {
+            Deserialize<Pod>(fd);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        ::close(fd);
+        std::filesystem::remove(hostile_path);
+
+        int pipe_fds[2];
+        assert(::pipe(pipe_fds) == 0);
+        assert(::write(pipe_fds[1], &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header)));
+        ::close(pipe_fds[1]);
+        try {
+            Deserialize<Pod>(pipe_fds[0]);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        ::close(pipe_fds[0]);
+    }
+    {
+        // Из канала данные читаются порциями, буфер растёт вместе с ними
+        const size_t PIPE_SIZE = 5 * detail::DESERIALIZE_CHUNK_BYTES / sizeof(Pod) + 3;
+        Vector<Pod> v(PIPE_SIZE);
+        for (uint32_t i = 0; i < PIPE_SIZE; ++i) {
+            v[i] = {i, i * 0.5f};
+        }
+        int pipe_fds[2];
+        assert(::pipe(pipe_fds) == 0);
+        std::thread writer([&v, fd = pipe_fds[1]] {
+            Serialize(fd, v);
+            ::close(fd);
+        });
+        const Vector<Pod> read = Deserialize<Pod>(pipe_fds[0]);
+        writer.join();
+        ::close(pipe_fds[0]);
+        assert(read.Size() == PIPE_SIZE && read[PIPE_SIZE - 1].id == PIPE_SIZE - 1 && read[1000].weight == 500.0f);
+    }
+    {
+        Vector<std::byte, AlignedAllocator<std::byte>> file(std::filesystem::file_size(path));
+        std::ifstream(path, std::ios::binary).read(reinterpret_cast<char*>(file.begin()), file.Size());
+        std::span<const Pod> view = ViewSerialized<Pod>(file.AsSpan());
+        assert(view.size() == SIZE && view[123].id == 123);
+        assert(view.data() == reinterpret_cast<const Pod*>(file.begin() + SERIALIZED_HEADER_SIZE));
+        try {
+            ViewSerialized<Pod>(file.AsSpan().first(SERIALIZED_HEADER_SIZE + 8));
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+        try {
+            ViewSerialized<Pod>(file.AsSpan().subspan(1));
+            assert(false);
+        } catch (const std::invalid_argument&) {
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+void Test26() {
+    auto bytes = [](std::string_view text) {
+        Vector<uint8_t> v(text.size());
+        std::copy(text.begin(), text.end(), v.begin());
+        return v;
+    };
+    {
+        assert(bytes("abc") == bytes("abc"));
+        assert(bytes("abc") != bytes("abd"));
+        assert(bytes("") == Vector<uint8_t>());
+        assert(bytes("abc") < bytes("abd"));
+        assert(bytes("ab") < bytes("abc"));
+        assert(bytes("\xff") > bytes("\x01\x02"));
+        assert((bytes("abc") <=> bytes("abc")) == std::strong_ordering::equal);
+        assert((Vector<uint8_t>() <=> Vector<uint8_t>()) == std::strong_ordering::equal);
+    }
+    {
+        Vector<int> a(3);
+        Vector<int> b(3);
+        std::iota(a.begin(), a.end(), -1);
+        std::iota(b.begin(), b.end(), -1);
+        assert(a == b && (a <=> b) == 0);
+        b[2] = -5;
+        assert(a != b && a > b);
+
+        Vector<double> nan(1);
+        nan[0] = std::numeric_limits<double>::quiet_NaN();
+        assert(nan != nan);
+        assert((nan <=> nan) == std::partial_ordering::unordered);
+
+        Vector<std::string> s1(2);
+        Vector<std::string> s2(2);
+        s1[1] = "x";
+        s2[1] = "y";
+        assert(s1 != s2 && s1 < s2);
+        s2[1] = "x";
+        assert(s1 == s2 && std::hash<Vector<std::string>>{}(s1) == std::hash<Vector<std::string>>{}(s2));
+    }
+    {
+        // Хеш зависит от каждого байта при любых длинах, включая границы блоков
+        std::hash<Vector<uint8_t>> hasher;
+        std::unordered_set<size_t> hashes;
+        std::string text;
+        for (size_t size = 0; size <= 200; ++size) {
+            hashes.insert(hasher(bytes(text)));
+            for (size_t i = 0; i < size; ++i) {
+                std::string changed = text;
+                changed[i] ^= 1;
+                assert(hasher(bytes(changed)) != hasher(bytes(text)));
+            }
+            text.push_back(static_cast<char>('a' + size % 26));
+        }
+        assert(hashes.size() == 201);
+
+        std::unordered_map<Vector<uint8_t>, int> cache;
+        cache[bytes("key")] = 1;
+        cache[bytes("other key")] = 2;
+        assert(cache.at(bytes("key")) == 1 && cache.count(bytes("missing")) == 0);
+    }
+}
+
+void Test27() {
+    static_assert(Vector<int>::BITWISE_COPY && Vector<int>::TRIVIAL_DESTROY);
+    static_assert(Vector<Vector<int>*>::BITWISE_COPY);
+    static_assert(pmr::Vector<double>::BITWISE_COPY && pmr::Vector<double>::TRIVIAL_DESTROY);
+    static_assert(!Vector<std::string>::BITWISE_COPY && !Vector<std::string>::TRIVIAL_DESTROY);
+    static_assert(!Vector<std::unique_ptr<int>>::BITWISE_COPY);
+    // Аллокатор сам создаёт объекты, и обходить его construct нельзя
+    static_assert(!Vector<int, ArenaAllocator<int>>::BITWISE_COPY && Vector<int, ArenaAllocator<int>>::TRIVIAL_DESTROY);
+    static_assert(detail::ElementOps<int, std::allocator<int>>::COPIES_BYTES_FROM<const int*>);
+    static_assert(!detail::ElementOps<int, std::allocator<int>>::COPIES_BYTES_FROM<std::list<int>::iterator>);
+    static_assert(!detail::ElementOps<int, std::allocator<int>>::COPIES_BYTES_FROM<const long*>);
+    {
+        Vector<int> v(1000);
+        std::iota(v.begin(), v.end(), 0);
+        Vector<int> copy(v);
+        assert(copy == v);
+
+        // Присваивание в меньший, больший и такой же по размеру вектор
+        Vector<int> small(10);
+        small = v;
+        assert(small == v);
+        Vector<int> big(5000);
+        const size_t capacity = big.Capacity();
+        big = v;
+        assert(big == v && big.Capacity() == capacity);
+        Vector<int> same(1000);
+        same = v;
+        assert(same == v);
+        Vector<int> empty;
+        v = empty;
+        assert(v.Size() == 0);
+
+        const std::vector<int> source{5, 6, 7};
+        big.Assign(source.begin(), source.end());
+        assert(big.Size() == 3 && big[0] == 5 && big[2] == 7);
+        const std::list<int> list{1, 2};
+        big.Assign(list.begin(), list.end());
+        assert(big.Size() == 2 && big[1] == 2);
+    }
+    {
+        ArenaStats stats;
+        Vector<int, ArenaAllocator<int>> v(3, ArenaAllocator<int>(&stats));
+        stats.constructions = 0;
+        Vector<int, ArenaAllocator<int>> copy(v);
+        assert(stats.constructions == 3);
+    }
+    {
+        SmallVector<int, 4> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(i);
+        }
+        SmallVector<int, 4> copy(v);
+        SmallVector<int, 4> assigned;
+        assigned.PushBack(42);
+        assigned = v;
+        assert(copy.Size() == 10 && assigned.Size() == 10 && assigned[9] == 9 && copy[5] == 5);
+    }
+}
+
+void Test28() {
+    {
+        Vector<int> data(100);
+        std::iota(data.begin(), data.end(), 0);
+        const CowVector<int> original(std::move(data));
+        CowVector<int> copy = original;
+        assert(original.UseCount() == 2 && std::as_const(copy).begin() == original.begin());
+
+        // Чтение через константную ссылку не отделяет буфер
+        assert(std::as_const(copy)[42] == 42 && copy.IsShared());
+        copy[42] = -1;
+        assert(!copy.IsShared() && !original.IsShared());
+        assert(copy[42] == -1 && original[42] == 42);
+
+        CowVector<int> erased = original;
+        erased.Erase(erased.cbegin() + 10, erased.cbegin() + 20);
+        erased.Emplace(erased.cbegin(), 1000);
+        assert(erased.Size() == 91 && erased[0] == 1000 && erased[11] == 20);
+        assert(original.Size() == 100 && original[10] == 10);
+
+        CowVector<int> cleared = original;
+        cleared.Clear();
+        assert(cleared.Size() == 0 && original.UseCount() == 1);
+        cleared.PushBack(5);
+        assert(cleared.Size() == 1 && cleared[0] == 5);
+    }
+    {
+        // Копирование не выделяет память под элементы, первое изменение выделяет
+        const CowVector<int> v{Vector<int>(10)};
+        const uint64_t allocations = GetVectorStats<int>().allocations;
+        Vector<CowVector<int>> workers;
+        for (int i = 0; i < 64; ++i) {
+            workers.PushBack(v);
+        }
+        assert(GetVectorStats<int>().allocations == allocations && v.UseCount() == 65);
+        workers[3][0] = 1;
+        assert(GetVectorStats<int>().allocations == allocations + CountedAllocations(1));
+        assert(v.UseCount() == 64 && workers[3][0] == 1 && v[0] == 0);
+    }
+    {
+        // Распространяемый аллокатор переходит вместе с разделяемым буфером
+        ArenaStats stats1;
+        ArenaStats stats2;
+        {
+            using Alloc = ArenaAllocator<int>;
+            const CowVector<int, Alloc> v1(Vector<int, Alloc>(10, Alloc{&stats1}));
+            CowVector<int, Alloc> v2(Vector<int, Alloc>(5, Alloc{&stats2}));
+            v2 = v1;
+            assert(v2.GetAllocator().stats == &stats1 && v1.UseCount() == 2);
+            CowVector<int, Alloc> v3(Vector<int, Alloc>(1, Alloc{&stats2}));
+            v3.Swap(v2);
+            assert(v3.GetAllocator().stats == &stats1 && v2.GetAllocator().stats == &stats2);
+            assert(stats2.allocations == stats2.deallocations + 2);
+        }
+        assert(stats1.allocations == stats1.deallocations);
+        assert(stats2.allocations == stats2.deallocations);
+    }
+    {
+        // Нераспространяемый аллокатор остаётся на месте, а элементы копируются в его буфер
+        ArenaStats stats1;
+        ArenaStats stats2;
+        {
+            using Alloc = ArenaAllocator<int, false>;
+            const CowVector<int, Alloc> v1(Vector<int, Alloc>(10, Alloc{&stats1}));
+            CowVector<int, Alloc> v2(Alloc{&stats2});
+            v2 = v1;
+            assert(v2.GetAllocator().stats == &stats2 && v2.Size() == 10 && !v1.IsShared());
+            CowVector<int, Alloc> v3(Vector<int, Alloc>(3, Alloc{&stats1}));
+            CowVector<int, Alloc> v4(Alloc{&stats2});
+            v4 = std::move(v3);
+            assert(v4.GetAllocator().stats == &stats2 && v4.Size() == 3 && v3.Size() == 0);
+            CowVector<int, Alloc> v5(Alloc{&stats2});
+            v5.Swap(v4);
+            assert(v5.Size() == 3 && v4.Size() == 0);
+        }
+        assert(stats1.allocations == stats1.deallocations);
+        assert(stats2.allocations == stats2.deallocations);
+    }
+    {
+        // Снимки, опубликованные писателем, читатели видят целыми
+        const int VERSIONS = 2000;
+        const size_t SIZE = 64;
+        auto make_version = [SIZE](int version) {
+            Vector<int> data(SIZE);
+            std::fill(data.begin(), data.end(), version);
+            return CowVector<int>(std::move(data));
+        };
+        AtomicCowVector<int> table(make_version(0));
+        std::atomic<bool> done = false;
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 3; ++i) {
+            readers.emplace_back([&] {
+                int last = 0;
+                while (!done.load()) {
+                    CowVector<int> snapshot = table.Load();
+                    assert(snapshot.Size() == SIZE);
+                    const int version = snapshot[0];
+                    assert(version >= last);
+                    assert(std::all_of(snapshot.begin(), snapshot.end(), [version](int x) {
+                        return x == version;
+                    }));
+                    last = version;
+                }
+            });
+        }
+        for (int version = 1; version <= VERSIONS; ++version) {
+            table.Store(make_version(version));
+            // Повторная публикация того же буфера
+            table.Store(table.Load());
+        }
+        done = true;
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+        const CowVector<int> last = table.Load();
+        assert(last[SIZE - 1] == VERSIONS && last.UseCount() == 2);
+        AtomicCowVector<int> empty;
+        assert(empty.Load().Size() == 0);
+    }
+}
+
+void Test29() {
+    const size_t SIZE = 40'000;
+    PersistentVector<int> base;
+    {
+        // Пакетное построение через TransientVector пересекает границы уровней дерева
+        TransientVector<int> transient;
+        for (size_t i = 0; i < SIZE; ++i) {
+            transient.PushBack(static_cast<int>(i));
+        }
+        const int& first = transient[0];
+        transient.EmplaceBack(-1);
+        assert(&first == &transient[0]);
+        transient.Set(SIZE, static_cast<int>(SIZE));
+        base = std::move(transient).Persistent();
+    }
+    assert(base.Size() == SIZE + 1);
+    for (size_t i = 0; i <= SIZE; i += 7) {
+        assert(base[i] == static_cast<int>(i));
+    }
+    {
+        // Новая версия копирует только лист и путь к нему
+        const uint64_t allocations = GetVectorStats<int>().allocations;
+        const PersistentVector<int> changed = base.Set(1234, -5);
+        assert(GetVectorStats<int>().allocations == allocations + CountedAllocations(1));
+        assert(changed[1234] == -5 && base[1234] == 1234 && changed[1235] == 1235);
+        assert(&changed[0] == &base[0] && &changed[1234] != &base[1234]);
+
+        Vector<int> expected = base.ToVector();
+        assert(expected.Size() == SIZE + 1 && expected[SIZE] == static_cast<int>(SIZE));
+        expected[1234] = -5;
+        assert(changed.ToVector() == expected);
+    }
+    {
+        // История версий, каждая на один элемент длиннее предыдущей
+        Vector<PersistentVector<std::string>> history;
+        history.EmplaceBack();
+        for (int i = 0; i < 1100; ++i) {
+            history.PushBack(history[i].PushBack(std::to_string(i)));
+        }
+        for (size_t version = 0; version < history.Size(); version += 37) {
+            assert(history[version].Size() == version);
+            for (size_t i = 0; i < version; i += 11) {
+                assert(history[version][i] == std::to_string(i));
+            }
+        }
+        const PersistentVector<std::string> edited = history[1000].Set(999, "edited").Set(0, "first");
+        assert(edited[999] == "edited" && history[1000][999] == "999" && history[1100][999] == "999");
+        assert(edited[0] == "first" && history[1][0] == "0");
+
+        TransientVector<std::string> batch = history[500].Transient();
+        for (int i = 0; i < 100; ++i) {
+            batch.Set(i, "batch");
+            batch.PushBack("more");
+        }
+        const PersistentVector<std::string> result = std::move(batch).Persistent();
+        assert(result.Size() == 600 && result[0] == "batch" && result[599] == "more" && result[100] == "100");
+        assert(history[500][0] == "0" && history[500].Size() == 500);
+
+        size_t chunks_size = 0;
+        result.ForEachChunk([&chunks_size](std::span<const std::string> chunk) {
+            assert(!chunk.empty() && chunk.size() <= 32);
+            chunks_size += chunk.size();
+        });
+        assert(chunks_size == 600);
+    }
+    {
+        Vector<int> source(100);
+        std::iota(source.begin(), source.end(), 0);
+        const PersistentVector<int> from_vector(source);
+        assert(from_vector.Size() == 100 && from_vector[99] == 99);
+        assert(from_vector.Transient().ToVector() == source);
+    }
+}
+
+void Test30() {
+    {
+        RingVector<int> queue;
+        for (int i = 0; i < 100; ++i) {
+            queue.PushBack(i);
+        }
+        for (int i = 0; i < 50; ++i) {
+            assert(queue.Front() == i);
+            queue.PopFront();
+        }
+        // Кольцо переходит через конец буфера и растёт с разрывом
+        const size_t capacity = queue.Capacity();
+        while (queue.Size() < capacity) {
+            queue.PushBack(static_cast<int>(queue.Back() + 1));
+        }
+        assert(queue.Capacity() == capacity && !queue.AsSpans().second.empty());
+        queue.PushBack(queue.Front());
+        assert(queue.Capacity() > capacity && queue.AsSpans().second.empty());
+        queue.PushFront(49);
+        assert(queue.Front() == 49 && queue[1] == 50 && queue.Back() == 50);
+        for (size_t i = 1; i + 1 < queue.Size(); ++i) {
+            assert(queue[i] == static_cast<int>(49 + i));
+        }
+        assert(std::is_sorted(queue.begin(), queue.end() - 1));
+        queue.PopBack();
+        queue.PopFront(10);
+        assert(queue.Front() == 59);
+    }
+    {
+        // AsSpans отдаёт очередь в writev без копирования
+        RingVector<char> queue;
+        queue.Reserve(8);
+        for (char c : std::string_view("xxxxxhello")) {
+            queue.PushBack(c);
+        }
+        queue.PopFront(5);
+        for (char c : std::string_view(", ring")) {
+            queue.PushBack(c);
+        }
+        auto [first, second] = queue.AsSpans();
+        iovec iov[2] = {{first.data(), first.size()}, {second.data(), second.size()}};
+        int fds[2];
+        assert(::pipe(fds) == 0);
+        assert(::writev(fds[1], iov, 2) == static_cast<ssize_t>(queue.Size()));
+        char received[16] = {};
+        assert(::read(fds[0], received, sizeof(received)) == static_cast<ssize_t>(queue.Size()));
+        ::close(fds[0]);
+        ::close(fds[1]);
+        assert(std::string_view(received) == "hello, ring");
+    }
+    {
+        // Рост со строгой гарантией: при ошибке копирования очередь не меняется
+        struct ThrowingMove : Obj {
+            using Obj::Obj;
+            ThrowingMove(const ThrowingMove&) = default;
+            ThrowingMove(ThrowingMove&& other) noexcept(false)
+            : Obj(other)  //
+            {
+            }
+        };
+        Obj::ResetCounters();
+        {
+            RingVector<ThrowingMove> queue;
+            for (int i = 0; i < 8; ++i) {
+                queue.EmplaceBack(i);
+            }
+            queue.PopFront(3);
+            for (int i = 8; i < 11; ++i) {
+                queue.EmplaceBack(i);
+            }
+            assert(queue.Size() == queue.Capacity());
+            queue[6].throw_on_copy = true;
+            try {
+                queue.EmplaceFront(-1);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            assert(queue.Size() == 8 && queue.Capacity() == 8 && queue.Front().id == 3 && queue.Back().id == 10);
+            assert(Obj::GetAliveObjectCount() == 8);
+            queue[6].throw_on_copy = false;
+            queue.EmplaceFront(2);
+            assert(queue.Size() == 9 && queue.Front().id == 2 && queue[8].id == 10);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Фиксированное кольцо ничего не выделяет
+        const uint64_t allocations = GetVectorStats<std::string>().allocations;
+        FixedRingVector<std::string, 4> queue;
+        for (int i = 0; i < 4; ++i) {
+            assert(queue.TryEmplaceBack(std::to_string(i)) != nullptr);
+        }
+        assert(queue.TryEmplaceBack("full") == nullptr && queue.TryEmplaceFront("full") == nullptr);
+        try {
+            queue.PushBack("full");
+            assert(false && "Exception is expected");
+        } catch (const std::length_error&) {
+        }
+        queue.PopFront();
+        queue.PushBack("4");
+        FixedRingVector<std::string, 4> copy = queue;
+        FixedRingVector<std::string, 4> other;
+        other.PushFront("other");
+        other.Swap(copy);
+        assert(other.Size() == 4 && other.Front() == "1" && other.Back() == "4");
+        assert(copy.Size() == 1 && copy.Front() == "other");
+        copy = std::move(other);
+        assert(copy.Size() == 4 && copy[3] == "4" && other.Size() == 0);
+        assert(GetVectorStats<std::string>().allocations == allocations);
+    }
+}
+
+namespace {
+
+    // Таблица, которая строится во время компиляции
+    constexpr StaticVector<int, 16> MakeSquares() {
+        StaticVector<int, 16> squares;
+        for (int i = 0; i < 10; ++i) {
+            squares.PushBack(i * i);
+        }
+        squares.Erase(squares.begin());
+        squares.Insert(squares.begin() + 2, -1);
+        squares.Resize(squares.Size() + 1);
+        squares.PopBack();
+        StaticVector<int, 16> copy = squares;
+        copy.EmplaceBack(100);
+        return copy;
+    }
+
+}  // namespace
+
+void Test31() {
+    {
+        static constexpr StaticVector<int, 16> SQUARES = MakeSquares();
+        static_assert(SQUARES.Size() == 11 && SQUARES[0] == 1 && SQUARES[2] == -1 && SQUARES[10] == 100);
+        static_assert(std::is_trivially_copyable_v<StaticVector<int, 16>>);
+        static_assert(!std::is_trivially_copyable_v<StaticVector<std::string, 4>>);
+        static_assert(StaticVector<int, 4>{1, 2} < StaticVector<int, 4>{1, 3});
+        assert(std::accumulate(SQUARES.begin(), SQUARES.end(), 0) == 384);
+    }
+    Obj::ResetCounters();
+    {
+        StaticVector<Obj, 8> v;
+        for (int i = 0; i < 8; ++i) {
+            assert(v.TryEmplaceBack(i) != nullptr);
+        }
+        assert(v.TryEmplaceBack(8) == nullptr && Obj::GetAliveObjectCount() == 8);
+        try {
+            v.EmplaceBack(8);
+            assert(false && "Exception is expected");
+        } catch (const std::length_error&) {
+        }
+        v.Erase(v.begin() + 1, v.begin() + 3);
+        assert(v.Size() == 6 && v[1].id == 3 && Obj::GetAliveObjectCount() == 6);
+        v.Insert(v.begin(), v[5]);
+        assert(v[0].id == 7 && v[1].id == 0 && v[6].id == 7);
+        v.Emplace(v.end(), 42);
+        assert(v.Size() == 8 && v[7].id == 42);
+
+        StaticVector<Obj, 8> copy = v;
+        StaticVector<Obj, 8> other(2);
+        other.Swap(copy);
+        assert(other.Size() == 8 && copy.Size() == 2 && other[7].id == 42);
+        copy = std::move(other);
+        assert(copy.Size() == 8 && other.Size() == 0);
+
+        v.Resize(3);
+        Obj::default_construction_throw_countdown = 3;
+        try {
+            v.Resize(8);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 3);
+        try {
+            v.Resize(9);
+            assert(false && "Exception is expected");
+        } catch (const std::length_error&) {
+        }
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+namespace {
+
+    // Первые N простых чисел. Vector используется только во время компиляции
+    template <size_t N>
+    constexpr std::array<int, N> FirstPrimes() {
+        Vector<int> primes;
+        for (int candidate = 2; primes.Size() < N; ++candidate) {
+            bool is_prime = true;
+            for (int prime : primes) {
+                if (prime * prime > candidate) {
+                    break;
+                }
+                if (candidate % prime == 0) {
+                    is_prime = false;
+                    break;
+                }
+            }
+            if (is_prime) {
+                primes.PushBack(candidate);
+            }
+        }
+        std::array<int, N> result{};
+        std::copy(primes.begin(), primes.end(), result.begin());
+        return result;
+    }
+
+    constexpr bool ConstexprVectorWorks() {
+        Vector<int> numbers(3);
+        numbers.Insert(numbers.begin() + 1, 2, 7);
+        numbers.EmplaceBack(9);
+        numbers.Erase(numbers.begin());
+        numbers.SwapAndPop(numbers.begin());
+        numbers.Reserve(100);
+        numbers.ShrinkToFit();
+        const Vector<int> numbers_copy = numbers;
+        if (numbers.Size() != 4 || numbers[0] != 9 || numbers[1] != 7 || numbers.Capacity() != 4
+            || !(numbers_copy == numbers)) {
+            return false;
+        }
+        numbers.Resize(1);
+        if (!(numbers < numbers_copy)) {
+            return false;
+        }
+
+        Vector<std::string> strings;
+        for (const char* text : {"this is a long string that does not fit into SSO", "b", "c"}) {
+            strings.EmplaceBack(text);
+        }
+        strings.Insert(strings.begin(), strings[2]);
+        strings.Erase(strings.begin() + 1, strings.begin() + 2);
+        Vector<std::string> moved = std::move(strings);
+        strings = moved;
+        strings.PopBack();
+        return moved.Size() == 3 && moved[0] == "c" && moved[1] == "b" && strings.Size() == 2
+               && (strings <=> moved) == std::strong_ordering::less;
+    }
+
+}  // namespace
+
+void Test32() {
+    static constexpr std::array<int, 16> PRIMES = FirstPrimes<16>();
+    static_assert(PRIMES[0] == 2 && PRIMES[15] == 53);
+    static_assert(ConstexprVectorWorks());
+    // Тот же код работает и во время выполнения
+    assert(ConstexprVectorWorks());
+    assert(FirstPrimes<16>() == PRIMES);
+}
+
+void Test33() {
+    using Allocator = HugePageAllocator<uint64_t, (size_t{1} << 20)>;
+    constexpr size_t HUGE_PAGE = Allocator::HUGE_PAGE_SIZE;
+    const auto is_huge_aligned = [](const void* p) {
+        return reinterpret_cast<uintptr_t>(p) % HUGE_PAGE == 0;
+    };
+    {
+        // Небольшие буферы выделяются обычным образом
+        Vector<uint64_t, Allocator> small(100);
+        assert(small.Capacity() == 100);
+        // Большие занимают целые большие страницы, и весь запас становится вместимостью
+        Vector<uint64_t, Allocator> v;
+        v.Resize(300'000);
+        assert(is_huge_aligned(v.begin()));
+        assert(v.Capacity() * sizeof(uint64_t) % HUGE_PAGE == 0 && v.Capacity() >= 300'000);
+        std::iota(v.begin(), v.end(), 0);
+        v.Resize(v.Capacity() + 1);
+        assert(is_huge_aligned(v.begin()) && v[299'999] == 299'999 && v[v.Size() - 1] == 0);
+        v.Resize(1000);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 1000 && v[999] == 999);
+    }
+    for (NumaPolicy policy : {NumaPolicy::Bind(0), NumaPolicy::Interleave(1)}) {
+        Vector<uint64_t, Allocator> v{Allocator(policy)};
+        v.Resize(500'000);
+        assert(is_huge_aligned(v.begin()) && v.GetAllocator().GetNumaPolicy().mode == policy.mode);
+        std::fill(v.begin(), v.end(), 7);
+        // Копия получает политику исходного вектора
+        Vector<uint64_t, Allocator> copy = v;
+        assert(copy == v && copy.GetAllocator().GetNumaPolicy().nodes == policy.nodes);
+    }
+    {
+        // Узла 63 нет: привязка к нему не удаётся. Небольшие буферы политика не затрагивает
+        Vector<uint64_t, Allocator> v{Allocator(NumaPolicy::Bind(63))};
+        v.Resize(1000);
+        try {
+            v.Resize(500'000);
+            assert(false && "Exception is expected");
+        } catch (const std::system_error&) {
+        }
+        assert(v.Size() == 1000);
+    }
+}
+
+namespace {
+
+    // Перемещение может выбросить исключение, поэтому элементы переносятся копированием
+    struct Fragile {
+        explicit Fragile(int value)
+        : value(value) {
+        }
+        Fragile(const Fragile& other)
+        : value(other.value) {
+            if (throw_on_copy) {
+                throw std::runtime_error("copy");
+            }
+        }
+        Fragile(Fragile&& other)
+        : value(other.value) {
+        }
+        static inline bool throw_on_copy = false;
+        int value;
+    };
+
+}  // namespace
+
+void Test34() {
+    Obj::ResetCounters();
+    {
+        // Каждый EmplaceBack переносит не больше двух элементов, а индексы указывают
+        // на нужный буфер на любом этапе переноса
+        IncrementalVector<Obj> v;
+        int max_moves = 0;
+        for (int i = 0; i < 1000; ++i) {
+            const int moved_before = Obj::num_moved;
+            v.EmplaceBack(i);
+            max_moves = std::max(max_moves, Obj::num_moved - moved_before);
+            assert(v[0].id == 0 && v[i / 2].id == i / 2 && v[i].id == i);
+        }
+        assert(max_moves == 2 && Obj::num_copied == 0 && Obj::num_moved < 2000);
+        assert(Obj::GetAliveObjectCount() == 1000);
+
+        // Рост с 1024 до 2048: перенос идёт, пока буфер не заполнится
+        for (int i = 1000; i < 1026; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v.Capacity() == 2048 && v.IsMigrating() && v.PendingMigration() == 1024 - 2);
+        assert(std::equal(v.begin(), v.end(), std::views::iota(0, 1026).begin(),
+                          [](const Obj& obj, int id) { return obj.id == id; }));
+
+        IncrementalVector<Obj> copy = v;
+        assert(!copy.IsMigrating() && copy.Size() == 1026 && copy[1025].id == 1025);
+
+        // Удаление из вектора, у которого в новом буфере не осталось элементов
+        while (v.Size() > 1020) {
+            v.PopBack();
+        }
+        assert(v.PendingMigration() == 1020 && v[1019].id == 1019);
+        v.EmplaceBack(-1);
+        assert(v.PendingMigration() == 1018 && v[1020].id == -1);
+
+        v.Swap(copy);
+        assert(v.Size() == 1026 && copy.Size() == 1021 && copy.IsMigrating());
+        copy = std::move(v);
+        assert(copy.Size() == 1026 && !copy.IsMigrating() && v.Size() == 0);
+        v.Clear();
+        assert(Obj::GetAliveObjectCount() == 1026);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        // Тривиально перемещаемые элементы переносятся блоками
+        IncrementalVector<int> v;
+        constexpr size_t STEP = IncrementalVector<int>::MIN_MIGRATION_STEP;
+        for (int i = 0; i < 2050; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Capacity() == 4096 && v.PendingMigration() == 2048 - STEP);
+        v.Migrate(10);
+        assert(v.PendingMigration() == 2048 - STEP - 10 && v[2047 - STEP - 10] == 2047 - STEP - 10);
+        for (int i = 2050; i < 3000; ++i) {
+            v.PushBack(i);
+        }
+        assert(!v.IsMigrating());
+        v.Reserve(5000);
+        assert(!v.IsMigrating() && v.Capacity() == 5000);
+        std::span<int> span = v.AsSpan();
+        assert(span.size() == 3000 && std::equal(span.begin(), span.end(), std::views::iota(0, 3000).begin()));
+    }
+    {
+        // Элемент, перенос которого выбросил исключение, остаётся в старом буфере,
+        // а добавление отменяется
+        IncrementalVector<Fragile> v;
+        for (int i = 0; i < 5; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v.Capacity() == 8 && v.PendingMigration() == 4);
+        Fragile::throw_on_copy = true;
+        try {
+            v.EmplaceBack(5);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        Fragile::throw_on_copy = false;
+        assert(v.Size() == 5 && v.PendingMigration() == 4 && v[3].value == 3 && v[4].value == 4);
+        v.FinishMigration();
+        assert(!v.IsMigrating() && v[0].value == 0 && v[1].value == 1);
+    }
+}
+
+namespace {
+
+    // Внедрение отказов. Событием считается каждое выделение памяти FailingAllocator
+    // и каждое копирование Tracked (а для Tracked с бросающим перемещением и каждое
+    // перемещение). Событие с номером fail_at выбрасывает исключение
+    struct FaultInjector {
+        static inline uint64_t events = 0;
+        static inline uint64_t fail_at = 0;
+        // Выделения памяти и число неосвобождённых блоков
+        static inline uint64_t allocations = 0;
+        static inline int64_t live_blocks = 0;
+
+        // При event == 0 отказов нет
+        static void Arm(uint64_t event) noexcept {
+            events = 0;
+            fail_at = event;
+        }
+
+        static void Hit(bool allocation) {
+            if (++events == fail_at) {
+                if (allocation) {
+                    throw std::bad_alloc();
+                }
+                throw std::runtime_error("Injected fault");
+            }
+        }
+    };
+
+    template <typename T>
+    struct FailingAllocator {
+        using value_type = T;
+
+        FailingAllocator() = default;
+
+        template <typename U>
+        FailingAllocator(const FailingAllocator<U>& /*other*/) noexcept {
+        }
+
+        T* allocate(size_t n) {
+            FaultInjector::Hit(true);
+            T* p = std::allocator<T>().allocate(n);
+            ++FaultInjector::allocations;
+            ++FaultInjector::live_blocks;
+            return p;
+        }
+
+        void deallocate(T* p, size_t n) noexcept {
+            --FaultInjector::live_blocks;
+            std::allocator<T>().deallocate(p, n);
+        }
+
+        template <typename U>
+        bool operator==(const FailingAllocator<U>& /*other*/) const noexcept {
+            return true;
+        }
+    };
+
+    // Элемент, который замечает повторное разрушение и чтение перемещённого объекта.
+    // При RELOCATABLE Vector переносит его побайтово
+    template <bool NOTHROW_MOVE, bool RELOCATABLE>
+    class Tracked {
+    public:
+        explicit Tracked(int value = 0) noexcept
+        : value_(value) {
+            ++alive;
+        }
+
+        Tracked(const Tracked& other)
+        : value_(other.Read()) {
+            FaultInjector::Hit(false);
+            ++alive;
+        }
+
+        Tracked(Tracked&& other) noexcept(NOTHROW_MOVE)
+        : value_(other.Read()) {
+            if constexpr (!NOTHROW_MOVE) {
+                FaultInjector::Hit(false);
+            }
+            other.state_ = MOVED_FROM;
+            ++alive;
+        }
+
+        Tracked& operator=(const Tracked& rhs) {
+            assert(state_ != DESTROYED);
+            FaultInjector::Hit(false);
+            value_ = rhs.Read();
+            state_ = VALID;
+            return *this;
+        }
+
+        Tracked& operator=(Tracked&& rhs) noexcept(NOTHROW_MOVE) {
+            assert(state_ != DESTROYED && this != &rhs);
+            if constexpr (!NOTHROW_MOVE) {
+                FaultInjector::Hit(false);
+            }
+            value_ = rhs.Read();
+            rhs.state_ = MOVED_FROM;
+            state_ = VALID;
+            return *this;
+        }
+
+        ~Tracked() {
+            assert(state_ != DESTROYED);
+            state_ = DESTROYED;
+            --alive;
+        }
+
+        int Value() const noexcept {
+            return value_;
+        }
+
+        bool IsMovedFrom() const noexcept {
+            return state_ == MOVED_FROM;
+        }
+
+        static inline int alive = 0;
+
+    private:
+        enum State : uint8_t { VALID, MOVED_FROM, DESTROYED };
+
+        int value_;
+        State state_ = VALID;
+
+        int Read() const noexcept {
+            assert(state_ == VALID);
+            return value_;
+        }
+    };
+
+    // Что операция обещает при исключении
+    enum Guarantee : uint8_t { NOTHROW, STRONG, BASIC };
+
+    // Случайные последовательности операций над Vector и std::vector<int> дают одинаковые
+    // значения. Примерно каждая вторая операция получает отказ на одном из первых событий;
+    // после отказа проверяется обещанная гарантия, а после каждой операции отсутствие
+    // утечек объектов и памяти
+    template <bool NOTHROW_MOVE, bool RELOCATABLE>
+    void RunDifferentialFuzz(uint32_t seed, int steps) {
+        using Value = Tracked<NOTHROW_MOVE, RELOCATABLE>;
+        using TestVector = Vector<Value, FailingAllocator<Value>>;
+        // Сдвиг элементов не выбрасывает исключений
+        constexpr bool SAFE_SHIFT = NOTHROW_MOVE || RELOCATABLE;
+
+        std::mt19937 rng(seed);
+        // Случайное число из [0, bound]
+        const auto random = [&rng](size_t bound) {
+            return std::uniform_int_distribution<size_t>(0, bound)(rng);
+        };
+        const auto values_of = [](const TestVector& vector) {
+            std::vector<int> values;
+            for (const Value& value : vector) {
+                values.push_back(value.Value());
+            }
+            return values;
+        };
+
+        TestVector v;
+        std::vector<int> expected;
+        for (int step = 0; step < steps; ++step) {
+            const size_t size = expected.size();
+            const size_t pos = random(size);
+            const int operation = static_cast<int>(random(size == 0 ? 4 : 11));
+            std::vector<Value> source(random(5));
+            for (Value& value : source) {
+                value = Value(static_cast<int>(random(1000)));
+            }
+            std::vector<int> source_values;
+            for (const Value& value : source) {
+                source_values.push_back(value.Value());
+            }
+            const std::vector<int> before = expected;
+            Guarantee guarantee = STRONG;
+
+            FaultInjector::Arm(random(1) == 0 ? random(7) + 1 : 0);
+            try {
+                switch (operation) {
+                    case 0:
+                        v.PushBack(Value(step));
+                        expected.push_back(step);
+                        break;
+                    case 1:
+                        guarantee = SAFE_SHIFT ? STRONG : BASIC;
+                        v.Insert(v.cbegin() + pos, Value(step));
+                        expected.insert(expected.begin() + pos, step);
+                        break;
+                    case 2:
+                        guarantee = RELOCATABLE ? STRONG : BASIC;
+                        v.Insert(v.cbegin() + pos, source.begin(), source.end());
+                        expected.insert(expected.begin() + pos, source_values.begin(), source_values.end());
+                        break;
+                    case 3:
+                        v.Reserve(random(2 * size + 8));
+                        break;
+                    case 4:
+                        v.Resize(random(size + 8));
+                        expected.resize(v.Size());
+                        break;
+                    case 5: {
+                        // Аргумент ссылается на элемент самого вектора
+                        const size_t index = random(size - 1);
+                        v.PushBack(v[index]);
+                        expected.push_back(expected[index]);
+                        break;
+                    }
+                    case 6: {
+                        guarantee = RELOCATABLE ? STRONG : BASIC;
+                        const size_t count = random(3);
+                        const size_t index = random(size - 1);
+                        v.Insert(v.cbegin() + pos, count, v[index]);
+                        expected.insert(expected.begin() + pos, count, before[index]);
+                        break;
+                    }
+                    case 7: {
+                        guarantee = SAFE_SHIFT ? NOTHROW : BASIC;
+                        const size_t first = random(size - 1);
+                        const size_t last = first + random(std::min<size_t>(size - first, 3));
+                        v.Erase(v.cbegin() + first, v.cbegin() + last);
+                        expected.erase(expected.begin() + first, expected.begin() + last);
+                        break;
+                    }
+                    case 8: {
+                        guarantee = SAFE_SHIFT ? NOTHROW : BASIC;
+                        const size_t index = random(size - 1);
+                        v.SwapAndPop(v.cbegin() + index);
+                        expected[index] = expected.back();
+                        expected.pop_back();
+                        break;
+                    }
+                    case 9:
+                        guarantee = NOTHROW;
+                        v.PopBack();
+                        expected.pop_back();
+                        break;
+                    case 10:
+                        v.ShrinkToFit();
+                        break;
+                    default:
+                        guarantee = BASIC;
+                        v.Assign(source.begin(), source.end());
+                        expected = source_values;
+                        break;
+                }
+            } catch (const std::exception&) {
+                assert(guarantee != NOTHROW);
+                assert(FaultInjector::events == FaultInjector::fail_at);
+                if (guarantee == STRONG) {
+                    assert(values_of(v) == before);
+                }
+                // Базовая гарантия: элементы остаются корректными, хотя часть может
+                // оказаться перемещённой
+                FaultInjector::Arm(0);
+                for (Value& value : v) {
+                    if (value.IsMovedFrom()) {
+                        value = Value(-1);
+                    }
+                }
+                expected = values_of(v);
+            }
+            FaultInjector::Arm(0);
+
+            assert(v.Size() == expected.size() && v.Capacity() >= v.Size());
+            assert(std::none_of(v.begin(), v.end(), [](const Value& value) {
+                return value.IsMovedFrom();
+            }));
+            assert(values_of(v) == expected);
+            assert(Value::alive == static_cast<int>(v.Size() + source.size()));
+            assert(FaultInjector::live_blocks == (v.Capacity() != 0 ? 1 : 0));
+        }
+        v.Clear();
+        assert(Value::alive == 0 && FaultInjector::live_blocks == 0);
+    }
+
+}  // namespace
+
+template <bool NOTHROW_MOVE>
+struct IsTriviallyRelocatable<Tracked<NOTHROW_MOVE, true>> : std::true_type {};
+
+void Test35() {
+    static_assert(IsTriviallyRelocatableV<Tracked<true, true>> && !IsTriviallyRelocatableV<Tracked<true, false>>);
+    for (uint32_t seed = 1; seed <= 4; ++seed) {
+        RunDifferentialFuzz<true, false>(seed, 3000);
+        RunDifferentialFuzz<false, false>(seed, 3000);
+        RunDifferentialFuzz<true, true>(seed, 3000);
+    }
+}
+
+void Test36() {
+    using Value = Tracked<true, false>;
+    using TestVector = Vector<Value, FailingAllocator<Value>>;
+    // Выполняет operation и возвращает число выделений памяти, которые она сделала
+    const auto allocations_of = [](auto&& operation) {
+        const uint64_t before = FaultInjector::allocations;
+        operation();
+        return FaultInjector::allocations - before;
+    };
+    {
+        TestVector v;
+        // Удвоение: вместимости 1, 2, 4, ..., 1024
+        assert(allocations_of([&] {
+                   for (int i = 0; i < 1000; ++i) {
+                       v.EmplaceBack(i);
+                   }
+               })
+               == 11);
+        TestVector copy;
+        assert(allocations_of([&] {
+                   copy = v;
+               })
+               == 1);
+        assert(allocations_of([&] {
+                   TestVector moved(std::move(copy));
+                   copy = std::move(moved);
+                   copy.Swap(v);
+               })
+               == 0);
+
+        // Вставка диапазона однонаправленных итераторов выделяет память не более одного раза
+        const std::vector<Value> source(3000);
+        assert(allocations_of([&] {
+                   v.Insert(v.cbegin() + 10, source.begin(), source.end());
+               })
+               == 1);
+        assert(allocations_of([&] {
+                   v.Erase(v.cbegin(), v.cbegin() + 100);
+                   v.Insert(v.cbegin(), 5, v[0]);
+                   v.Assign(source.begin(), source.begin() + 100);
+                   v.Resize(3000);
+                   v.Clear(false);
+                   v.Append(source);
+               })
+               == 0);
+        assert(allocations_of([&] {
+                   v.ShrinkToFit();
+               })
+               == 1);
+    }
+    {
+        TestVector v;
+        assert(allocations_of([&] {
+                   v.Reserve(1000);
+                   for (int i = 0; i < 1000; ++i) {
+                       v.PushBack(Value(i));
+                   }
+                   v.Resize(500);
+               })
+               == 1);
+    }
+    {
+        // Перенос при постепенном росте не выделяет память сверх самого роста
+        IncrementalVector<Value, FailingAllocator<Value>> v;
+        assert(allocations_of([&] {
+                   for (int i = 0; i < 1000; ++i) {
+                       v.EmplaceBack(i);
+                   }
+               })
+               == 11);
+        // Встроенный буфер SmallVector не требует динамической памяти
+        SmallVector<Value, 16, FailingAllocator<Value>> small;
+        assert(allocations_of([&] {
+                   for (int i = 0; i < 16; ++i) {
+                       small.EmplaceBack(i);
+                   }
+               })
+               == 0);
     }
+    assert(Value::alive == 0 && FaultInjector::live_blocks == 0);
 }
 
 int main() {
@@ -647,8 +3170,38 @@ int main() {
         Test4();
         Test5();
         Test6();
-        Benchmark();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
+        Test35();
+        Test36();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
+        return 1;
     }
 }
@@ -0,0 +1,404 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Отображённая в память область: файл либо анонимная память. В отличие от RawMemory
+// содержимое области переживает перевыделение и (для файла) сам процесс, поэтому
+// в ней можно хранить только тривиально копируемые объекты
+class MappedMemory {
+public:
+    MappedMemory() = default;
+
+    // Отображает файл path целиком, создавая его при отсутствии.
+    // При truncate == true содержимое файла отбрасывается
+    static MappedMemory OpenFile(const std::string& path, bool truncate) {
+        MappedMemory memory;
+        memory.fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0644);
+        if (memory.fd_ < 0) {
+            ThrowSystemError("open");
+        }
+        struct stat st {};
+        if (::fstat(memory.fd_, &st) != 0) {
+            ThrowSystemError("fstat");
+        }
+        if (st.st_size != 0) {
+            memory.Map(static_cast<size_t>(st.st_size));
+        }
+        return memory;
+    }
+
+    // Анонимная память. При huge_pages == true ядро просят использовать прозрачные
+    // большие страницы, что сокращает промахи TLB на больших буферах
+    static MappedMemory Anonymous(bool huge_pages) noexcept {
+        MappedMemory memory;
+        memory.huge_pages_ = huge_pages;
+        return memory;
+    }
+
+    MappedMemory(const MappedMemory&) = delete;
+    MappedMemory& operator=(const MappedMemory&) = delete;
+
+    MappedMemory(MappedMemory&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1))
+    , address_(std::exchange(other.address_, nullptr))
+    , bytes_(std::exchange(other.bytes_, 0))
+    , huge_pages_(other.huge_pages_) {
+    }
+
+    MappedMemory& operator=(MappedMemory&& rhs) noexcept {
+        if (this != &rhs) {
+            Release();
+            fd_ = std::exchange(rhs.fd_, -1);
+            address_ = std::exchange(rhs.address_, nullptr);
+            bytes_ = std::exchange(rhs.bytes_, 0);
+            huge_pages_ = rhs.huge_pages_;
+        }
+        return *this;
+    }
+
+    ~MappedMemory() {
+        Release();
+    }
+
+    std::byte* GetAddress() noexcept {
+        return static_cast<std::byte*>(address_);
+    }
+
+    const std::byte* GetAddress() const noexcept {
+        return static_cast<const std::byte*>(address_);
+    }
+
+    size_t Bytes() const noexcept {
+        return bytes_;
+    }
+
+    bool IsFile() const noexcept {
+        return fd_ >= 0;
+    }
+
+    // Изменяет размер области (и файла) до bytes с сохранением содержимого. Добавленные
+    // байты нулевые. Адрес области может измениться. При ошибке область остаётся прежней
+    void Resize(size_t bytes) {
+        if (bytes == bytes_) {
+            return;
+        }
+        if (IsFile() && ::ftruncate(fd_, static_cast<off_t>(bytes)) != 0) {
+            ThrowSystemError("ftruncate");
+        }
+        if (address_ == nullptr) {
+            Map(bytes);
+            return;
+        }
+#if defined(__linux__)
+        void* address = ::mremap(address_, bytes_, bytes, MREMAP_MAYMOVE);
+        if (address == MAP_FAILED) {
+            if (IsFile()) {
+                [[maybe_unused]] int rollback = ::ftruncate(fd_, static_cast<off_t>(bytes_));
+            }
+            ThrowSystemError("mremap");
+        }
+        address_ = address;
+        bytes_ = bytes;
+        Advise();
+#else
+        // Новая область только заимствует дескриптор, поэтому ошибка её отображения
+        // не затрагивает ни дескриптор, ни текущую область
+        void* address = MAP_FAILED;
+        try {
+            address = MapRegion(fd_, bytes);
+        } catch (...) {
+            if (IsFile()) {
+                [[maybe_unused]] int rollback = ::ftruncate(fd_, static_cast<off_t>(bytes_));
+            }
+            throw;
+        }
+        if (!IsFile()) {
+            std::memcpy(address, address_, std::min(bytes, bytes_));
+        }
+        ::munmap(address_, bytes_);
+        address_ = address;
+        bytes_ = bytes;
+        Advise();
+#endif
+    }
+
+    // Записывает изменения файла на диск
+    void Sync() {
+        if (IsFile() && address_ != nullptr && ::msync(address_, bytes_, MS_SYNC) != 0) {
+            ThrowSystemError("msync");
+        }
+    }
+
+private:
+    int fd_ = -1;
+    void* address_ = nullptr;
+    size_t bytes_ = 0;
+    bool huge_pages_ = false;
+
+    [[noreturn]] static void ThrowSystemError(const char* operation) {
+        throw std::system_error(errno, std::generic_category(), std::string("MappedMemory: ") + operation);
+    }
+
+    // Отображает bytes байтов файла fd или, при fd < 0, анонимной памяти.
+    // Дескриптор остаётся во владении вызывающего
+    static void* MapRegion(int fd, size_t bytes) {
+        const int flags = fd >= 0 ? MAP_SHARED : MAP_PRIVATE | MAP_ANONYMOUS;
+        void* address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, flags, fd, 0);
+        if (address == MAP_FAILED) {
+            ThrowSystemError("mmap");
+        }
+        return address;
+    }
+
+    void Map(size_t bytes) {
+        address_ = MapRegion(fd_, bytes);
+        bytes_ = bytes;
+        Advise();
+    }
+
+    void Advise() noexcept {
+#if defined(MADV_HUGEPAGE)
+        if (huge_pages_ && !IsFile()) {
+            // Подсказка необязательна: без поддержки ядра память остаётся обычной
+            ::madvise(address_, bytes_, MADV_HUGEPAGE);
+        }
+#endif
+    }
+
+    void Release() noexcept {
+        if (address_ != nullptr) {
+            ::munmap(address_, bytes_);
+            address_ = nullptr;
+            bytes_ = 0;
+        }
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+};
+
+// Вектор тривиально копируемых элементов в отображённой в память области. Вектор,
+// открытый из файла, сохраняет в нём элементы и размер: повторное открытие не читает
+// и не разбирает данные, а страницы подгружаются ядром при первом обращении.
+// Файл начинается с заголовка, за которым следуют элементы.
+// Рост вектора увеличивает файл через ftruncate и перевыделяет отображение через
+// mremap, поэтому, как и у Vector, рост делает недействительными указатели на элементы
+template <typename T, typename Growth = DoublingGrowth>
+class MappedVector {
+public:
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "MappedVector хранит только тривиально копируемые типы");
+
+    // Смещение элементов от начала файла
+    static constexpr size_t DATA_OFFSET = 64;
+    static_assert(alignof(T) <= DATA_OFFSET, "Выравнивание элементов превышает смещение данных");
+
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    // Пустой вектор в анонимной памяти
+    MappedVector() = default;
+
+    // Открывает вектор, сохранённый в файле path, или создаёт пустой, если файла нет
+    static MappedVector Open(const std::string& path) {
+        return MappedVector(MappedMemory::OpenFile(path, false));
+    }
+
+    // Создаёт в файле path пустой вектор, отбрасывая прежнее содержимое файла
+    static MappedVector Create(const std::string& path) {
+        return MappedVector(MappedMemory::OpenFile(path, true));
+    }
+
+    // Вектор в анонимной памяти, по возможности на больших страницах
+    static MappedVector Anonymous(bool huge_pages = true) {
+        return MappedVector(MappedMemory::Anonymous(huge_pages));
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept
+    : memory_(std::move(other.memory_))
+    , size_(std::exchange(other.size_, 0)) {
+    }
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            memory_ = std::move(rhs.memory_);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + size_;
+    }
+    const_iterator begin() const noexcept {
+        return Data();
+    }
+    const_iterator end() const noexcept {
+        return Data() + size_;
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<MappedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return memory_.Bytes() <= DATA_OFFSET ? 0 : (memory_.Bytes() - DATA_OFFSET) / sizeof(T);
+    }
+
+    static constexpr size_t MaxSize() noexcept {
+        return (std::numeric_limits<std::ptrdiff_t>::max() - 2 * PAGE_SIZE) / sizeof(T);
+    }
+
+    // Аргументы могут ссылаться на элементы вектора
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        const T value(std::forward<Args>(args)...);
+        if (size_ == Capacity()) {
+            Reserve(GrowthCapacity(size_ + 1));
+        }
+        T* slot = ::new (static_cast<void*>(Data() + size_)) T(value);
+        SetSize(size_ + 1);
+        return *slot;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        SetSize(size_ - 1);
+    }
+
+    // Увеличивает файл или анонимную область так, чтобы в неё поместилось new_capacity
+    // элементов. Размер области округляется до целого числа страниц
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        if (new_capacity > MaxSize()) {
+            throw std::length_error("MappedVector: requested capacity exceeds MaxSize()");
+        }
+        const bool is_new = memory_.Bytes() == 0;
+        memory_.Resize((DATA_OFFSET + new_capacity * sizeof(T) + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE);
+        if (is_new) {
+            *GetHeader() = Header{MAGIC, sizeof(T), 0};
+        }
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size > size_) {
+            if (new_size > Capacity()) {
+                Reserve(GrowthCapacity(new_size));
+            }
+            for (T* p = Data() + size_; p != Data() + new_size; ++p) {
+                ::new (static_cast<void*>(p)) T();
+            }
+        }
+        if (new_size != size_) {
+            SetSize(new_size);
+        }
+    }
+
+    // Уменьшает файл или анонимную область до размера, необходимого элементам
+    void ShrinkToFit() {
+        if (memory_.Bytes() != 0) {
+            memory_.Resize((DATA_OFFSET + size_ * sizeof(T) + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE);
+        }
+    }
+
+    // Записывает элементы и размер на диск
+    void Sync() {
+        memory_.Sync();
+    }
+
+private:
+    // Сигнатура и версия формата файла
+    static constexpr uint64_t MAGIC = 0x4d56'4543'0000'0001;
+    static constexpr size_t PAGE_SIZE = 4096;
+
+    // Заголовок в начале отображённой области
+    struct Header {
+        uint64_t magic;
+        uint64_t element_size;
+        uint64_t size;
+    };
+    static_assert(sizeof(Header) <= DATA_OFFSET);
+
+    MappedMemory memory_ = MappedMemory::Anonymous(false);
+    size_t size_ = 0;
+
+    explicit MappedVector(MappedMemory memory)
+    : memory_(std::move(memory)) {
+        if (memory_.Bytes() == 0) {
+            return;
+        }
+        if (memory_.Bytes() < DATA_OFFSET || GetHeader()->magic != MAGIC) {
+            throw std::invalid_argument("MappedVector: file is not a MappedVector");
+        }
+        const Header& header = *GetHeader();
+        if (header.element_size != sizeof(T)) {
+            throw std::invalid_argument("MappedVector: element size mismatch");
+        }
+        if (header.size > Capacity()) {
+            throw std::invalid_argument("MappedVector: file is truncated");
+        }
+        size_ = header.size;
+    }
+
+    Header* GetHeader() noexcept {
+        return reinterpret_cast<Header*>(memory_.GetAddress());
+    }
+
+    T* Data() noexcept {
+        return memory_.Bytes() == 0 ? nullptr : reinterpret_cast<T*>(memory_.GetAddress() + DATA_OFFSET);
+    }
+
+    const T* Data() const noexcept {
+        return const_cast<MappedVector&>(*this).Data();
+    }
+
+    void SetSize(size_t size) noexcept {
+        size_ = size;
+        GetHeader()->size = size;
+    }
+
+    size_t GrowthCapacity(size_t required) const {
+        if (required > MaxSize()) {
+            throw std::length_error("MappedVector: requested size exceeds MaxSize()");
+        }
+        return std::clamp(Growth::NextCapacity(Capacity(), required, sizeof(T)), required, MaxSize());
+    }
+};
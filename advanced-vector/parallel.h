@@ -0,0 +1,297 @@
+#pragma once
+
+#include "vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Пул потоков для параллельных проходов по непрерывным диапазонам. Задача делится на
+// фрагменты, которые потоки пула и вызвавший поток разбирают по одному, пока они
+// не кончатся, поэтому более быстрые потоки берут на себя больше фрагментов
+class ThreadPool {
+public:
+    // Пул из num_workers фоновых потоков. Вызвавший Run поток работает вместе с ними
+    explicit ThreadPool(size_t num_workers) {
+        workers_.reserve(num_workers);
+        for (size_t i = 0; i != num_workers; ++i) {
+            workers_.emplace_back([this] {
+                WorkerLoop();
+            });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        has_jobs_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    // Общий пул на все ядра процессора
+    static ThreadPool& Shared() {
+        static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+        return pool;
+    }
+
+    // Число потоков, выполняющих задачу, включая вызвавший
+    size_t Concurrency() const noexcept {
+        return workers_.size() + 1;
+    }
+
+    // Вызывает task(i) для каждого i из [0, count) и ждёт завершения всех вызовов.
+    // Если вызовы выбросили исключения, после завершения выбрасывается первое из них,
+    // а ещё не начатые вызовы пропускаются. Вызов из задачи пула выполняется в текущем потоке
+    template <typename Task>
+    void Run(size_t count, Task&& task) {
+        if (count == 0) {
+            return;
+        }
+        if (count == 1 || workers_.empty() || is_worker_) {
+            for (size_t i = 0; i != count; ++i) {
+                task(i);
+            }
+            return;
+        }
+
+        Job job;
+        job.invoke = [](void* task, size_t i) {
+            (*static_cast<std::remove_reference_t<Task>*>(task))(i);
+        };
+        job.task = const_cast<void*>(static_cast<const void*>(std::addressof(task)));
+        job.count = count;
+        {
+            std::lock_guard lock(mutex_);
+            jobs_.push_back(&job);
+        }
+        has_jobs_.notify_all();
+
+        Work(job);
+
+        std::unique_lock lock(mutex_);
+        if (auto it = std::find(jobs_.begin(), jobs_.end(), &job); it != jobs_.end()) {
+            jobs_.erase(it);
+        }
+        // Фоновые потоки могут ещё обращаться к job, даже когда все вызовы завершены
+        job_done_.wait(lock, [&job] {
+            return job.done.load(std::memory_order_acquire) == job.count && job.num_users == 0;
+        });
+        if (job.error) {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+private:
+    struct Job {
+        void (*invoke)(void* task, size_t i) = nullptr;
+        void* task = nullptr;
+        size_t count = 0;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        // Число фоновых потоков, работающих над задачей. Защищено mutex_ пула
+        size_t num_users = 0;
+    };
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable has_jobs_;
+    std::condition_variable job_done_;
+    std::deque<Job*> jobs_;
+    bool stop_ = false;
+
+    static inline thread_local bool is_worker_ = false;
+
+    // Выполняет ещё не разобранные вызовы задачи
+    void Work(Job& job) {
+        for (size_t i; (i = job.next.fetch_add(1, std::memory_order_relaxed)) < job.count;) {
+            if (!job.failed.load(std::memory_order_relaxed)) {
+                try {
+                    job.invoke(job.task, i);
+                } catch (...) {
+                    std::lock_guard lock(mutex_);
+                    if (!job.error) {
+                        job.error = std::current_exception();
+                    }
+                    job.failed.store(true, std::memory_order_relaxed);
+                }
+            }
+            if (job.done.fetch_add(1, std::memory_order_acq_rel) + 1 == job.count) {
+                std::lock_guard lock(mutex_);
+                job_done_.notify_all();
+            }
+        }
+    }
+
+    void WorkerLoop() {
+        is_worker_ = true;
+        std::unique_lock lock(mutex_);
+        while (true) {
+            has_jobs_.wait(lock, [this] {
+                return stop_ || !jobs_.empty();
+            });
+            if (jobs_.empty()) {
+                return;
+            }
+            Job* job = jobs_.front();
+            if (job->next.load(std::memory_order_relaxed) >= job->count) {
+                jobs_.pop_front();
+                continue;
+            }
+            ++job->num_users;
+            lock.unlock();
+            Work(*job);
+            lock.lock();
+            if (--job->num_users == 0) {
+                job_done_.notify_all();
+            }
+        }
+    }
+};
+
+namespace detail {
+
+// Делит count элементов размером element_size на фрагменты. Фрагмент не меньше 32 КиБ,
+// чтобы затраты на его выдачу были незаметны, и кратен кэш-линии, чтобы потоки не
+// записывали в одну линию. Фрагментов в несколько раз больше, чем потоков, чтобы
+// нагрузка распределялась равномерно
+struct Chunking {
+    static constexpr size_t MIN_CHUNK_BYTES = size_t{32} << 10;
+    static constexpr size_t CACHE_LINE = 64;
+    static constexpr size_t CHUNKS_PER_THREAD = 4;
+
+    Chunking(size_t count, size_t element_size, size_t concurrency) noexcept
+    : count(count) {
+        const size_t line = std::max<size_t>(CACHE_LINE / element_size, 1);
+        const size_t min_chunk = std::max<size_t>(MIN_CHUNK_BYTES / element_size, 1);
+        chunk_size = std::max(count / (concurrency * CHUNKS_PER_THREAD), min_chunk);
+        chunk_size = (chunk_size + line - 1) / line * line;
+        num_chunks = (count + chunk_size - 1) / chunk_size;
+    }
+
+    size_t Begin(size_t chunk) const noexcept {
+        return chunk * chunk_size;
+    }
+
+    size_t End(size_t chunk) const noexcept {
+        return std::min(count, (chunk + 1) * chunk_size);
+    }
+
+    size_t count;
+    size_t chunk_size;
+    size_t num_chunks;
+};
+
+}  // namespace detail
+
+// Вызывает function(element) для каждого элемента диапазона
+template <std::ranges::contiguous_range Range, typename Function>
+void ParallelForEach(Range&& range, Function function, ThreadPool& pool = ThreadPool::Shared()) {
+    auto* data = std::ranges::data(range);
+    const detail::Chunking chunks(std::ranges::size(range), sizeof(*data), pool.Concurrency());
+    pool.Run(chunks.num_chunks, [&](size_t chunk) {
+        std::for_each(data + chunks.Begin(chunk), data + chunks.End(chunk), std::ref(function));
+    });
+}
+
+// Записывает в out[i] результат function(in[i]). Размеры диапазонов должны совпадать
+template <std::ranges::contiguous_range In, std::ranges::contiguous_range Out, typename Function>
+void ParallelTransform(const In& in, Out&& out, Function function, ThreadPool& pool = ThreadPool::Shared()) {
+    assert(std::ranges::size(in) == std::ranges::size(out));
+    const auto* src = std::ranges::data(in);
+    auto* dst = std::ranges::data(out);
+    const detail::Chunking chunks(std::ranges::size(in), sizeof(*dst), pool.Concurrency());
+    pool.Run(chunks.num_chunks, [&](size_t chunk) {
+        std::transform(src + chunks.Begin(chunk), src + chunks.End(chunk), dst + chunks.Begin(chunk),
+                       std::ref(function));
+    });
+}
+
+// Свёртка элементов диапазона и init операцией op, которая должна быть ассоциативной.
+// Фрагменты сворачиваются параллельно, а их результаты по порядку, поэтому для
+// фиксированного числа потоков результат воспроизводим
+template <std::ranges::contiguous_range Range, typename T, typename BinaryOp = std::plus<>>
+T ParallelReduce(const Range& range, T init, BinaryOp op = {}, ThreadPool& pool = ThreadPool::Shared()) {
+    const auto* data = std::ranges::data(range);
+    const detail::Chunking chunks(std::ranges::size(range), sizeof(*data), pool.Concurrency());
+    std::vector<std::optional<T>> partial(chunks.num_chunks);
+    pool.Run(chunks.num_chunks, [&](size_t chunk) {
+        const auto* first = data + chunks.Begin(chunk);
+        const auto* last = data + chunks.End(chunk);
+        T acc(*first);
+        for (++first; first != last; ++first) {
+            acc = op(std::move(acc), *first);
+        }
+        partial[chunk].emplace(std::move(acc));
+    });
+    for (std::optional<T>& value : partial) {
+        init = op(std::move(init), std::move(*value));
+    }
+    return init;
+}
+
+// Сортирует диапазон: фрагменты сортируются параллельно, затем попарно сливаются.
+// Сортировка неустойчива, как std::sort
+template <std::ranges::contiguous_range Range, typename Compare = std::less<>>
+void ParallelSort(Range&& range, Compare comp = {}, ThreadPool& pool = ThreadPool::Shared()) {
+    auto* data = std::ranges::data(range);
+    const detail::Chunking chunks(std::ranges::size(range), sizeof(*data), pool.Concurrency());
+    pool.Run(chunks.num_chunks, [&](size_t chunk) {
+        std::sort(data + chunks.Begin(chunk), data + chunks.End(chunk), comp);
+    });
+    for (size_t width = 1; width < chunks.num_chunks; width *= 2) {
+        const size_t num_merges = (chunks.num_chunks + 2 * width - 1) / (2 * width);
+        pool.Run(num_merges, [&](size_t merge) {
+            const size_t first_chunk = merge * 2 * width;
+            if (first_chunk + width < chunks.num_chunks) {
+                std::inplace_merge(data + chunks.Begin(first_chunk), data + chunks.Begin(first_chunk + width),
+                                   data + chunks.End(std::min(first_chunk + 2 * width, chunks.num_chunks) - 1),
+                                   comp);
+            }
+        });
+    }
+}
+
+// Resize, в котором новые элементы тривиальных типов обнуляются параллельно. Каждую
+// страницу нового буфера первым записывает поток, обрабатывающий её фрагмент, поэтому
+// на NUMA-системах страницы распределяются между узлами этих потоков.
+// Элементы остальных типов создаются обычным Resize
+template <typename T, typename Alloc, typename Growth>
+void ParallelResize(Vector<T, Alloc, Growth>& vector, size_t new_size, ThreadPool& pool = ThreadPool::Shared()) {
+    if constexpr (std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>) {
+        const size_t old_size = vector.Size();
+        if (new_size <= old_size) {
+            vector.Resize(new_size);
+            return;
+        }
+        vector.ResizeAndOverwrite(new_size, [&](T* data, size_t count) {
+            const detail::Chunking chunks(count - old_size, sizeof(T), pool.Concurrency());
+            pool.Run(chunks.num_chunks, [&](size_t chunk) {
+                std::fill(data + old_size + chunks.Begin(chunk), data + old_size + chunks.End(chunk), T{});
+            });
+            return count;
+        });
+    } else {
+        vector.Resize(new_size);
+    }
+}
@@ -0,0 +1,510 @@
+#pragma once
+
+#include "vector.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+template <typename T, typename Alloc>
+class PersistentVector;
+
+template <typename T, typename Alloc>
+class TransientVector;
+
+namespace detail {
+
+// 32-ичное префиксное дерево с отдельным последним листом (хвостом), общее для
+// PersistentVector и TransientVector. Элементы лежат в листах по 32 в буферах RawMemory,
+// внутренние узлы хранят по 32 указателя на потомков. Узлы разделяются версиями и считают
+// ссылки на себя: перед изменением узел, на который ссылается кто-то ещё, копируется
+// вместе с путём к нему от корня, а узел с единственной ссылкой меняется на месте.
+// Адреса элементов не меняются, пока элемент принадлежит хотя бы одной версии
+template <typename T, typename Alloc>
+class Trie {
+public:
+    static constexpr unsigned BITS = 5;
+    static constexpr size_t WIDTH = size_t{1} << BITS;
+    static constexpr size_t MASK = WIDTH - 1;
+
+    explicit Trie(const Alloc& alloc = Alloc()) noexcept
+    : alloc_(alloc) {
+    }
+
+    Trie(const Trie& other) noexcept
+    : alloc_(other.alloc_)
+    , root_(other.root_)
+    , tail_(other.tail_)
+    , size_(other.size_)
+    , shift_(other.shift_)  //
+    {
+        AddRef(root_);
+        AddRef(tail_);
+    }
+
+    Trie(Trie&& other) noexcept
+    : alloc_(other.alloc_)
+    , root_(std::exchange(other.root_, nullptr))
+    , tail_(std::exchange(other.tail_, nullptr))
+    , size_(std::exchange(other.size_, 0))
+    , shift_(std::exchange(other.shift_, BITS))  //
+    {
+    }
+
+    Trie& operator=(const Trie& rhs) noexcept {
+        Trie rhs_copy(rhs);
+        Swap(rhs_copy);
+        return *this;
+    }
+
+    Trie& operator=(Trie&& rhs) noexcept {
+        if (this != &rhs) {
+            Trie rhs_copy(std::move(rhs));
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    ~Trie() {
+        Release(root_, shift_);
+        Release(tail_, 0);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    const Alloc& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    const T& Get(size_t index) const noexcept {
+        assert(index < size_);
+        if (index >= TailOffset()) {
+            return AsLeaf(tail_)->values[index & MASK];
+        }
+        const Node* node = root_;
+        for (unsigned level = shift_; level > 0; level -= BITS) {
+            node = AsInner(node)->children[(index >> level) & MASK];
+        }
+        return AsLeaf(node)->values[index & MASK];
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (tail_ == nullptr || size_ - TailOffset() == WIDTH) {
+            // Новый элемент начинает новый хвост, а полный хвост уходит в дерево
+            Node* leaf = NewLeaf();
+            T* slot = AsLeaf(leaf)->values.GetAddress();
+            try {
+                Ops::Construct(alloc_, slot, std::forward<Args>(args)...);
+                AsLeaf(leaf)->count = 1;
+                if (tail_ != nullptr) {
+                    PushTail();
+                }
+            } catch (...) {
+                Release(leaf, 0);
+                throw;
+            }
+            tail_ = leaf;
+            ++size_;
+            return *slot;
+        }
+        Leaf* tail = MakeUniqueLeaf(tail_);
+        T* slot = tail->values + tail->count;
+        Ops::Construct(alloc_, slot, std::forward<Args>(args)...);
+        ++tail->count;
+        ++size_;
+        return *slot;
+    }
+
+    template <typename U>
+    void Set(size_t index, U&& value) {
+        assert(index < size_);
+        Leaf* leaf = nullptr;
+        if (index >= TailOffset()) {
+            leaf = MakeUniqueLeaf(tail_);
+        } else {
+            Node** slot = &root_;
+            for (unsigned level = shift_; level > 0; level -= BITS) {
+                slot = &MakeUniqueInner(*slot, level)->children[(index >> level) & MASK];
+            }
+            leaf = MakeUniqueLeaf(*slot);
+        }
+        leaf->values[index & MASK] = std::forward<U>(value);
+    }
+
+    // Вызывает visitor(const T* data, size_t count) для каждого листа по порядку
+    template <typename Visitor>
+    void ForEachLeaf(Visitor&& visitor) const {
+        VisitLeaves(root_, shift_, visitor);
+        if (tail_ != nullptr) {
+            visitor(static_cast<const T*>(AsLeaf(tail_)->values.GetAddress()), AsLeaf(tail_)->count);
+        }
+    }
+
+    void Swap(Trie& other) noexcept {
+        std::swap(alloc_, other.alloc_);
+        std::swap(root_, other.root_);
+        std::swap(tail_, other.tail_);
+        std::swap(size_, other.size_);
+        std::swap(shift_, other.shift_);
+    }
+
+private:
+    using Ops = ElementOps<T, Alloc>;
+
+    struct Node {
+        std::atomic<size_t> refs{1};
+    };
+
+    struct Inner : Node {
+        Node* children[WIDTH] = {};
+    };
+
+    struct Leaf : Node {
+        explicit Leaf(const Alloc& alloc)
+        : values(WIDTH, alloc)  //
+        {
+        }
+
+        RawMemory<T, Alloc> values;
+        // Число созданных элементов
+        size_t count = 0;
+    };
+
+    using InnerAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Inner>;
+    using LeafAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Leaf>;
+
+    [[no_unique_address]] Alloc alloc_;
+    // Корень на уровне shift_: потомки узла уровня level выбираются битами индекса с level
+    // по level + BITS - 1, узлы уровня 0 являются листами
+    Node* root_ = nullptr;
+    Node* tail_ = nullptr;
+    size_t size_ = 0;
+    unsigned shift_ = BITS;
+
+    static Inner* AsInner(Node* node) noexcept {
+        return static_cast<Inner*>(node);
+    }
+    static const Inner* AsInner(const Node* node) noexcept {
+        return static_cast<const Inner*>(node);
+    }
+    static Leaf* AsLeaf(Node* node) noexcept {
+        return static_cast<Leaf*>(node);
+    }
+    static const Leaf* AsLeaf(const Node* node) noexcept {
+        return static_cast<const Leaf*>(node);
+    }
+
+    // Индекс первого элемента хвоста
+    size_t TailOffset() const noexcept {
+        return size_ < WIDTH ? 0 : ((size_ - 1) >> BITS) << BITS;
+    }
+
+    Node* NewInner() {
+        InnerAlloc alloc(alloc_);
+        Inner* node = std::allocator_traits<InnerAlloc>::allocate(alloc, 1);
+        return ::new (static_cast<void*>(node)) Inner;
+    }
+
+    Node* NewLeaf() {
+        LeafAlloc alloc(alloc_);
+        Leaf* leaf = std::allocator_traits<LeafAlloc>::allocate(alloc, 1);
+        try {
+            return ::new (static_cast<void*>(leaf)) Leaf(alloc_);
+        } catch (...) {
+            std::allocator_traits<LeafAlloc>::deallocate(alloc, leaf, 1);
+            throw;
+        }
+    }
+
+    static void AddRef(Node* node) noexcept {
+        if (node != nullptr) {
+            node->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Отпускает ссылку на узел уровня level. Последняя ссылка освобождает узел и отпускает потомков
+    void Release(Node* node, unsigned level) noexcept {
+        if (node == nullptr || node->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        if (level == 0) {
+            Leaf* leaf = AsLeaf(node);
+            Ops::DestroyN(alloc_, leaf->values.GetAddress(), leaf->count);
+            leaf->~Leaf();
+            LeafAlloc alloc(alloc_);
+            std::allocator_traits<LeafAlloc>::deallocate(alloc, leaf, 1);
+        } else {
+            Inner* inner = AsInner(node);
+            for (Node* child : inner->children) {
+                Release(child, level - BITS);
+            }
+            inner->~Inner();
+            InnerAlloc alloc(alloc_);
+            std::allocator_traits<InnerAlloc>::deallocate(alloc, inner, 1);
+        }
+    }
+
+    // Делает внутренний узел в slot принадлежащим только этой версии
+    Inner* MakeUniqueInner(Node*& slot, unsigned level) {
+        if (slot->refs.load(std::memory_order_acquire) != 1) {
+            Node* copy = NewInner();
+            std::copy(std::begin(AsInner(slot)->children), std::end(AsInner(slot)->children),
+                      AsInner(copy)->children);
+            for (Node* child : AsInner(copy)->children) {
+                AddRef(child);
+            }
+            Release(std::exchange(slot, copy), level);
+        }
+        return AsInner(slot);
+    }
+
+    Leaf* MakeUniqueLeaf(Node*& slot) {
+        if (slot->refs.load(std::memory_order_acquire) != 1) {
+            Node* copy = NewLeaf();
+            const Leaf* source = AsLeaf(slot);
+            try {
+                Ops::UninitializedCopyN(alloc_, static_cast<const T*>(source->values.GetAddress()), source->count,
+                                        AsLeaf(copy)->values.GetAddress());
+            } catch (...) {
+                Release(copy, 0);
+                throw;
+            }
+            AsLeaf(copy)->count = source->count;
+            Release(std::exchange(slot, copy), 0);
+        }
+        return AsLeaf(slot);
+    }
+
+    // Цепочка новых внутренних узлов от уровня level до листа leaf
+    Node* NewPath(unsigned level, Node* leaf) {
+        if (level == 0) {
+            return leaf;
+        }
+        Node* node = NewInner();
+        try {
+            AsInner(node)->children[0] = NewPath(level - BITS, leaf);
+        } catch (...) {
+            Release(node, level);
+            throw;
+        }
+        return node;
+    }
+
+    // Переносит полный хвост в дерево. Хвост не отпускается: ссылку на него забирает дерево
+    void PushTail() {
+        if (root_ == nullptr) {
+            root_ = NewInner();
+            AsInner(root_)->children[0] = tail_;
+            shift_ = BITS;
+        } else if ((size_ >> BITS) > (size_t{1} << shift_)) {
+            // Корень заполнен: дерево вырастает на уровень
+            Node* root = NewInner();
+            try {
+                AsInner(root)->children[1] = NewPath(shift_, tail_);
+            } catch (...) {
+                Release(root, shift_ + BITS);
+                throw;
+            }
+            AsInner(root)->children[0] = root_;
+            root_ = root;
+            shift_ += BITS;
+        } else {
+            PushTailInto(root_, shift_);
+        }
+    }
+
+    void PushTailInto(Node*& slot, unsigned level) {
+        Node*& child = MakeUniqueInner(slot, level)->children[((size_ - 1) >> level) & MASK];
+        if (level == BITS) {
+            child = tail_;
+        } else if (child != nullptr) {
+            PushTailInto(child, level - BITS);
+        } else {
+            child = NewPath(level - BITS, tail_);
+        }
+    }
+
+    template <typename Visitor>
+    static void VisitLeaves(const Node* node, unsigned level, Visitor& visitor) {
+        if (node == nullptr) {
+            return;
+        }
+        if (level == 0) {
+            visitor(static_cast<const T*>(AsLeaf(node)->values.GetAddress()), AsLeaf(node)->count);
+            return;
+        }
+        for (const Node* child : AsInner(node)->children) {
+            VisitLeaves(child, level - BITS, visitor);
+        }
+    }
+};
+
+}  // namespace detail
+
+// Неизменяемый вектор: Set и PushBack не меняют вектор, а возвращают новую версию,
+// которая разделяет с исходной все узлы, кроме O(log32 N) узлов на пути к изменённому
+// элементу. Копирование версии стоит O(1). Версии можно читать и копировать из разных
+// потоков одновременно. Для пакетного построения используется TransientVector.
+// Узлы выделяются аллокатором Alloc: для пулов узлов подходит, например,
+// std::pmr::polymorphic_allocator поверх unsynchronized_pool_resource
+template <typename T, typename Alloc = std::allocator<T>>
+class PersistentVector {
+public:
+    using allocator_type = Alloc;
+
+    PersistentVector() = default;
+
+    explicit PersistentVector(const Alloc& alloc) noexcept
+    : trie_(alloc) {
+    }
+
+    template <typename Growth>
+    explicit PersistentVector(const Vector<T, Alloc, Growth>& vector)
+    : trie_(vector.GetAllocator()) {
+        for (const T& value : vector) {
+            trie_.EmplaceBack(value);
+        }
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return trie_.Get(index);
+    }
+
+    size_t Size() const noexcept {
+        return trie_.Size();
+    }
+
+    const Alloc& GetAllocator() const noexcept {
+        return trie_.GetAllocator();
+    }
+
+    // Версия с value в конце. Вызов у временного объекта меняет его узлы на месте
+    [[nodiscard]] PersistentVector PushBack(T value) const& {
+        return PersistentVector(*this).PushBack(std::move(value));
+    }
+
+    [[nodiscard]] PersistentVector PushBack(T value) && {
+        trie_.EmplaceBack(std::move(value));
+        return std::move(*this);
+    }
+
+    // Версия, в которой элемент index равен value
+    [[nodiscard]] PersistentVector Set(size_t index, T value) const& {
+        return PersistentVector(*this).Set(index, std::move(value));
+    }
+
+    [[nodiscard]] PersistentVector Set(size_t index, T value) && {
+        trie_.Set(index, std::move(value));
+        return std::move(*this);
+    }
+
+    // Изменяемая копия для пакетных изменений. Копируются только узлы, которые она меняет
+    TransientVector<T, Alloc> Transient() const& {
+        return TransientVector<T, Alloc>(trie_);
+    }
+
+    TransientVector<T, Alloc> Transient() && {
+        return TransientVector<T, Alloc>(std::move(trie_));
+    }
+
+    // Вызывает visitor(std::span<const T>) для непрерывных участков элементов по порядку
+    template <typename Visitor>
+    void ForEachChunk(Visitor visitor) const {
+        trie_.ForEachLeaf([&visitor](const T* data, size_t count) {
+            visitor(std::span<const T>(data, count));
+        });
+    }
+
+    template <typename Growth = DoublingGrowth>
+    Vector<T, Alloc, Growth> ToVector() const {
+        Vector<T, Alloc, Growth> result(GetAllocator());
+        result.Reserve(Size());
+        ForEachChunk([&result](std::span<const T> chunk) {
+            result.Insert(result.cend(), chunk.begin(), chunk.end());
+        });
+        return result;
+    }
+
+    void Swap(PersistentVector& other) noexcept {
+        trie_.Swap(other.trie_);
+    }
+
+private:
+    friend class TransientVector<T, Alloc>;
+    using Trie = detail::Trie<T, Alloc>;
+
+    Trie trie_;
+
+    explicit PersistentVector(Trie trie) noexcept
+    : trie_(std::move(trie)) {
+    }
+};
+
+// Изменяемый вектор на тех же узлах, что и PersistentVector. Меняет на месте узлы,
+// которые принадлежат только ему, поэтому пакетное построение не копирует узлы.
+// Как и Vector, не предназначен для одновременного изменения из нескольких потоков
+template <typename T, typename Alloc = std::allocator<T>>
+class TransientVector {
+public:
+    using allocator_type = Alloc;
+
+    TransientVector() = default;
+
+    explicit TransientVector(const Alloc& alloc) noexcept
+    : trie_(alloc) {
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return trie_.Get(index);
+    }
+
+    size_t Size() const noexcept {
+        return trie_.Size();
+    }
+
+    const Alloc& GetAllocator() const noexcept {
+        return trie_.GetAllocator();
+    }
+
+    // Ссылки на элементы остаются действительными при добавлении новых
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        return trie_.EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    template <typename U>
+    void Set(size_t index, U&& value) {
+        trie_.Set(index, std::forward<U>(value));
+    }
+
+    // Неизменяемая версия с текущими элементами. Сам TransientVector становится пустым
+    PersistentVector<T, Alloc> Persistent() && noexcept {
+        return PersistentVector<T, Alloc>(std::move(trie_));
+    }
+
+    template <typename Growth = DoublingGrowth>
+    Vector<T, Alloc, Growth> ToVector() const {
+        return PersistentVector<T, Alloc>(trie_).template ToVector<Growth>();
+    }
+
+private:
+    friend class PersistentVector<T, Alloc>;
+    using Trie = detail::Trie<T, Alloc>;
+
+    Trie trie_;
+
+    explicit TransientVector(Trie trie) noexcept
+    : trie_(std::move(trie)) {
+    }
+};
@@ -0,0 +1,437 @@
+#pragma once
+
+#include "index_iterator.h"
+#include "vector.h"
+
+#include <compare>
+#include <iterator>
+#include <span>
+#include <utility>
+
+namespace detail {
+
+// Буфер кольца в динамической памяти, растущий по политике Growth
+template <typename T, typename Alloc, typename Growth>
+class HeapRingStorage {
+public:
+    using allocator_type = Alloc;
+    static constexpr bool CAN_GROW = true;
+
+    HeapRingStorage() = default;
+
+    explicit HeapRingStorage(const Alloc& alloc) noexcept
+    : memory_(alloc) {
+    }
+
+    HeapRingStorage(size_t capacity, const Alloc& alloc)
+    : memory_(capacity, alloc) {
+    }
+
+    T* GetAddress() noexcept {
+        return memory_.GetAddress();
+    }
+
+    const T* GetAddress() const noexcept {
+        return memory_.GetAddress();
+    }
+
+    size_t Capacity() const noexcept {
+        return memory_.Capacity();
+    }
+
+    Alloc& GetAllocator() noexcept {
+        return memory_.GetAllocator();
+    }
+
+    const Alloc& GetAllocator() const noexcept {
+        return memory_.GetAllocator();
+    }
+
+    size_t GrowthCapacity(size_t required) const {
+        const size_t capacity = std::max(Growth::NextCapacity(Capacity(), required, sizeof(T)), required);
+        StatsHooks<T>::OnGrowth(required, capacity);
+        return capacity;
+    }
+
+    void Swap(HeapRingStorage& other) noexcept {
+        memory_.Swap(other.memory_);
+    }
+
+private:
+    RawMemory<T, Alloc> memory_;
+};
+
+// Буфер кольца на N элементов внутри самого объекта. Память не выделяется никогда
+template <typename T, size_t N>
+class InlineRingStorage {
+    static_assert(N > 0, "Вместимость кольца должна быть положительной");
+
+public:
+    using allocator_type = std::allocator<T>;
+    static constexpr bool CAN_GROW = false;
+
+    InlineRingStorage() = default;
+
+    explicit InlineRingStorage(const allocator_type&) noexcept {
+    }
+
+    T* GetAddress() noexcept {
+        return buffer_.values;
+    }
+
+    const T* GetAddress() const noexcept {
+        return buffer_.values;
+    }
+
+    static constexpr size_t Capacity() noexcept {
+        return N;
+    }
+
+    allocator_type& GetAllocator() noexcept {
+        return alloc_;
+    }
+
+    const allocator_type& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+private:
+    union Buffer {
+        Buffer() noexcept {
+        }
+        ~Buffer() {
+        }
+        T values[N];
+    };
+
+    Buffer buffer_;
+    [[no_unique_address]] allocator_type alloc_;
+};
+
+}  // namespace detail
+
+// Очередь с двумя концами в одном кольцевом буфере: PushBack, PushFront, PopBack и
+// PopFront выполняются за O(1) и не сдвигают остальные элементы. Элементы лежат не
+// более чем двумя непрерывными участками, которые возвращает AsSpans (например, для
+// writev). Рост кольца даёт ту же строгую гарантию безопасности, что и Vector::Reserve.
+// Хранилище задаётся параметром Storage: RingVector растёт в динамической памяти,
+// FixedRingVector хранит элементы в самом объекте и при переполнении выбрасывает
+// std::length_error (TryEmplaceBack и TryEmplaceFront вместо этого возвращают nullptr)
+template <typename T, typename Storage>
+class BasicRingVector {
+public:
+    using allocator_type = typename Storage::allocator_type;
+    using iterator = detail::IndexIterator<BasicRingVector, T, false>;
+    using const_iterator = detail::IndexIterator<BasicRingVector, T, true>;
+    using Spans = std::pair<std::span<T>, std::span<T>>;
+    using ConstSpans = std::pair<std::span<const T>, std::span<const T>>;
+
+    BasicRingVector() = default;
+
+    explicit BasicRingVector(const allocator_type& alloc) noexcept
+    : storage_(alloc) {
+    }
+
+    BasicRingVector(const BasicRingVector& other)
+    : BasicRingVector(AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
+        Reserve(other.size_);
+        for (const T& value : other) {
+            EmplaceBack(value);
+        }
+    }
+
+    BasicRingVector(BasicRingVector&& other) noexcept(Storage::CAN_GROW || std::is_nothrow_move_constructible_v<T>)
+    : storage_(other.GetAllocator()) {
+        if constexpr (Storage::CAN_GROW) {
+            storage_.Swap(other.storage_);
+            head_ = std::exchange(other.head_, 0);
+            size_ = std::exchange(other.size_, 0);
+        } else {
+            MoveElementsFrom(other);
+        }
+    }
+
+    BasicRingVector& operator=(const BasicRingVector& rhs) {
+        if (this != &rhs) {
+            BasicRingVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    BasicRingVector& operator=(BasicRingVector&& rhs) noexcept(Storage::CAN_GROW
+                                                               || std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            if constexpr (Storage::CAN_GROW) {
+                BasicRingVector rhs_copy(std::move(rhs));
+                Swap(rhs_copy);
+            } else {
+                Clear();
+                MoveElementsFrom(rhs);
+            }
+        }
+        return *this;
+    }
+
+    ~BasicRingVector() {
+        Clear();
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<BasicRingVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return storage_.GetAddress()[Wrap(head_ + index)];
+    }
+
+    T& Front() noexcept {
+        return (*this)[0];
+    }
+    const T& Front() const noexcept {
+        return (*this)[0];
+    }
+    T& Back() noexcept {
+        return (*this)[size_ - 1];
+    }
+    const T& Back() const noexcept {
+        return (*this)[size_ - 1];
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return storage_.Capacity();
+    }
+
+    const allocator_type& GetAllocator() const noexcept {
+        return storage_.GetAllocator();
+    }
+
+    // Элементы по порядку: сначала участок от начала очереди до конца буфера,
+    // затем участок, перешедший в начало буфера (возможно, пустой)
+    Spans AsSpans() noexcept {
+        T* data = storage_.GetAddress();
+        const size_t first = std::min(size_, Capacity() - head_);
+        return {std::span<T>(data + head_, first), std::span<T>(data, size_ - first)};
+    }
+
+    ConstSpans AsSpans() const noexcept {
+        auto [first, second] = const_cast<BasicRingVector&>(*this).AsSpans();
+        return {first, second};
+    }
+
+    // Аргументы могут ссылаться на элементы очереди
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            return GrowAndEmplace(false, std::forward<Args>(args)...);
+        }
+        T* slot = storage_.GetAddress() + Wrap(head_ + size_);
+        Ops::Construct(Allocator(), slot, std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    template <typename... Args>
+    T& EmplaceFront(Args&&... args) {
+        if (size_ == Capacity()) {
+            return GrowAndEmplace(true, std::forward<Args>(args)...);
+        }
+        const size_t new_head = head_ == 0 ? Capacity() - 1 : head_ - 1;
+        T* slot = storage_.GetAddress() + new_head;
+        Ops::Construct(Allocator(), slot, std::forward<Args>(args)...);
+        head_ = new_head;
+        ++size_;
+        return *slot;
+    }
+
+    // Добавляет элемент, только если для него есть место без роста буфера
+    template <typename... Args>
+    T* TryEmplaceBack(Args&&... args) {
+        return size_ == Capacity() ? nullptr : &EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    T* TryEmplaceFront(Args&&... args) {
+        return size_ == Capacity() ? nullptr : &EmplaceFront(std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+    void PushFront(const T& value) {
+        EmplaceFront(value);
+    }
+    void PushFront(T&& value) {
+        EmplaceFront(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        Ops::Destroy(Allocator(), &Back());
+        --size_;
+    }
+
+    void PopFront() noexcept {
+        assert(size_ != 0);
+        Ops::Destroy(Allocator(), &Front());
+        head_ = Wrap(head_ + 1);
+        --size_;
+    }
+
+    // Удаляет count элементов из начала очереди, например после частичной отправки
+    void PopFront(size_t count) noexcept {
+        assert(count <= size_);
+        auto [first, second] = AsSpans();
+        const size_t from_first = std::min(count, first.size());
+        Ops::DestroyN(Allocator(), first.data(), from_first);
+        Ops::DestroyN(Allocator(), second.data(), count - from_first);
+        head_ = size_ == count ? 0 : Wrap(head_ + count);
+        size_ -= count;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        if constexpr (Storage::CAN_GROW) {
+            Storage new_storage(new_capacity, GetAllocator());
+            RelocateTo(new_storage.GetAddress());
+            Replace(new_storage);
+        } else {
+            throw std::length_error("FixedRingVector: requested capacity exceeds its fixed capacity");
+        }
+    }
+
+    void Clear() noexcept {
+        PopFront(size_);
+    }
+
+    void Swap(BasicRingVector& other) noexcept(Storage::CAN_GROW || std::is_nothrow_move_constructible_v<T>) {
+        if constexpr (Storage::CAN_GROW) {
+            storage_.Swap(other.storage_);
+            std::swap(head_, other.head_);
+            std::swap(size_, other.size_);
+        } else {
+            BasicRingVector tmp(std::move(other));
+            other.MoveElementsFrom(*this);
+            MoveElementsFrom(tmp);
+        }
+    }
+
+private:
+    using AllocTraits = std::allocator_traits<allocator_type>;
+    using Ops = detail::ElementOps<T, allocator_type>;
+    using Stats = detail::StatsHooks<T>;
+
+    Storage storage_;
+    // Индекс первого элемента в буфере
+    size_t head_ = 0;
+    size_t size_ = 0;
+
+    allocator_type& Allocator() noexcept {
+        return storage_.GetAllocator();
+    }
+
+    // Перемещает в пустую очередь элементы other, которая затем очищается.
+    // Нужен встроенному буферу, который нельзя передать другому объекту
+    void MoveElementsFrom(BasicRingVector& other) {
+        for (T& value : other) {
+            EmplaceBack(std::move(value));
+        }
+        other.Clear();
+    }
+
+    // Индекс в буфере для позиции из [0, 2 * Capacity())
+    size_t Wrap(size_t position) const noexcept {
+        return position >= Capacity() ? position - Capacity() : position;
+    }
+
+    // Создаёт элемент в буфере большей вместимости, затем переносит туда остальные.
+    // Новый элемент оказывается первым (at_front) или последним
+    template <typename... Args>
+    T& GrowAndEmplace(bool at_front, Args&&... args) {
+        if constexpr (Storage::CAN_GROW) {
+            if (size_ == std::numeric_limits<size_t>::max() / sizeof(T)) {
+                throw std::length_error("RingVector: size exceeds MaxSize()");
+            }
+            Storage new_storage(storage_.GrowthCapacity(size_ + 1), GetAllocator());
+            T* data = new_storage.GetAddress();
+            T* slot = at_front ? data : data + size_;
+            Ops::Construct(Allocator(), slot, std::forward<Args>(args)...);
+            try {
+                RelocateTo(at_front ? data + 1 : data);
+            } catch (...) {
+                Ops::Destroy(Allocator(), slot);
+                throw;
+            }
+            Replace(new_storage);
+            ++size_;
+            return *slot;
+        } else {
+            throw std::length_error("FixedRingVector: capacity exceeded");
+        }
+    }
+
+    // Переносит элементы по порядку в сырую память to. Если перенос выбросит
+    // исключение, элементы очереди останутся нетронутыми
+    void RelocateTo(T* to) {
+        auto [first, second] = AsSpans();
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            Ops::CopyBytes(to, first.data(), first.size());
+            Ops::CopyBytes(to + first.size(), second.data(), second.size());
+        } else {
+            Ops::CopyOrMoveData(Allocator(), first.data(), first.size(), to);
+            try {
+                Ops::CopyOrMoveData(Allocator(), second.data(), second.size(), to + first.size());
+            } catch (...) {
+                Ops::DestroyN(Allocator(), to, first.size());
+                throw;
+            }
+        }
+    }
+
+    // Разрушает перенесённые элементы старого буфера и переключается на new_storage
+    void Replace(Storage& new_storage) noexcept {
+        Stats::OnReallocate(Capacity());
+        if constexpr (!IsTriviallyRelocatableV<T>) {
+            auto [first, second] = AsSpans();
+            Ops::DestroyN(Allocator(), first.data(), first.size());
+            Ops::DestroyN(Allocator(), second.data(), second.size());
+        }
+        storage_.Swap(new_storage);
+        head_ = 0;
+    }
+};
+
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+using RingVector = BasicRingVector<T, detail::HeapRingStorage<T, Alloc, Growth>>;
+
+template <typename T, size_t N>
+using FixedRingVector = BasicRingVector<T, detail::InlineRingStorage<T, N>>;
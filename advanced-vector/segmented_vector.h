@@ -0,0 +1,270 @@
+#pragma once
+
+#include "index_iterator.h"
+#include "segments.h"
+#include "vector.h"
+
+// Вектор, который растёт добавлением сегментов удваивающегося размера и никогда не
+// переносит элементы: указатели и ссылки на элементы остаются действительными, пока
+// элемент не удалён. Рост стоит O(1) без переноса, а старый и новый буферы никогда
+// не существуют одновременно. Элементы лежат непрерывно только внутри сегмента
+template <typename T, typename Alloc = std::allocator<T>>
+class SegmentedVector {
+public:
+    using iterator = detail::IndexIterator<SegmentedVector, T, false>;
+    using const_iterator = detail::IndexIterator<SegmentedVector, T, true>;
+    using allocator_type = Alloc;
+
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(const Alloc& alloc) noexcept
+    : alloc_(alloc) {
+    }
+
+    explicit SegmentedVector(size_t size, const Alloc& alloc = Alloc())
+    : SegmentedVector(alloc) {
+        Resize(size);
+    }
+
+    SegmentedVector(const SegmentedVector& other)
+    : SegmentedVector(AllocTraits::select_on_container_copy_construction(other.alloc_)) {
+        AssignN(other.begin(), other.size_);
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+    : alloc_(std::move(other.alloc_))
+    , segments_(std::exchange(other.segments_, nullptr))
+    , num_segments_(std::exchange(other.num_segments_, 0))
+    , size_(std::exchange(other.size_, 0)) {
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (!AllocTraits::is_always_equal::value && alloc_ != rhs.alloc_) {
+                    // Сегменты нужно вернуть старому аллокатору до его замены
+                    Clear();
+                }
+                alloc_ = rhs.alloc_;
+            }
+            AssignN(rhs.begin(), rhs.size_);
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                                               || AllocTraits::is_always_equal::value) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                Clear();
+                alloc_ = std::move(rhs.alloc_);
+                TakeSegments(rhs);
+            } else if (AllocTraits::is_always_equal::value || alloc_ == rhs.alloc_) {
+                Clear();
+                TakeSegments(rhs);
+            } else {
+                // Забрать сегменты rhs нельзя: они принадлежат другому аллокатору
+                AssignN(std::make_move_iterator(rhs.begin()), rhs.size_);
+            }
+        }
+        return *this;
+    }
+
+    ~SegmentedVector() {
+        Clear();
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SegmentedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return *At(index);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return Layout::SegmentStart(num_segments_);
+    }
+
+    static constexpr size_t MaxSize() noexcept {
+        return std::min(Layout::MAX_SIZE, std::numeric_limits<std::ptrdiff_t>::max() / sizeof(T));
+    }
+
+    const Alloc& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Аргументы могут ссылаться на элементы вектора: при росте элементы не переезжают
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            AddSegment();
+        }
+        T* slot = At(size_);
+        AllocTraits::construct(alloc_, slot, std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        DestroyTail(size_ - 1);
+    }
+
+    // Выделяет сегменты, чтобы в вектор поместилось new_capacity элементов
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > MaxSize()) {
+            throw std::length_error("SegmentedVector: requested capacity exceeds MaxSize()");
+        }
+        const size_t num_segments = Layout::SegmentsFor(new_capacity);
+        while (num_segments_ < num_segments) {
+            AddSegment();
+        }
+    }
+
+    // Если конструктор нового элемента выбросит исключение, размер вектора не изменится
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            DestroyTail(new_size);
+        } else if (new_size > size_) {
+            Reserve(new_size);
+            const size_t old_size = size_;
+            try {
+                while (size_ < new_size) {
+                    EmplaceBack();
+                }
+            } catch (...) {
+                DestroyTail(old_size);
+                throw;
+            }
+        }
+    }
+
+    // Удаляет все элементы. При release == true освобождает и сегменты
+    void Clear(bool release = true) noexcept {
+        DestroyTail(0);
+        if (release && segments_ != nullptr) {
+            while (num_segments_ != 0) {
+                --num_segments_;
+                const size_t count = Layout::SegmentSize(num_segments_);
+                Stats::OnDeallocate(count);
+                AllocTraits::deallocate(alloc_, segments_[num_segments_], count);
+            }
+            TableAlloc table_alloc(alloc_);
+            TableTraits::deallocate(table_alloc, segments_, Layout::MAX_SEGMENTS);
+            segments_ = nullptr;
+        }
+    }
+
+    // Аллокаторы обмениваются, только если это разрешает propagate_on_container_swap,
+    // иначе аллокаторы обоих векторов должны быть равны
+    void Swap(SegmentedVector& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(AllocTraits::is_always_equal::value || alloc_ == other.alloc_);
+        }
+        std::swap(segments_, other.segments_);
+        std::swap(num_segments_, other.num_segments_);
+        std::swap(size_, other.size_);
+    }
+
+private:
+    using Layout = detail::SegmentLayout<4>;
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using TableAlloc = typename AllocTraits::template rebind_alloc<T*>;
+    using TableTraits = std::allocator_traits<TableAlloc>;
+    using Stats = detail::StatsHooks<T>;
+
+    [[no_unique_address]] Alloc alloc_;
+    // Таблица адресов сегментов на Layout::MAX_SEGMENTS элементов, выделяется вместе с
+    // первым сегментом. Сегмент k вмещает Layout::SegmentSize(k) элементов. Таблица и
+    // сегменты выделяются и освобождаются аллокатором alloc_
+    T** segments_ = nullptr;
+    size_t num_segments_ = 0;
+    size_t size_ = 0;
+
+    // Адрес ячейки index в выделенных сегментах
+    T* At(size_t index) noexcept {
+        const auto [segment, offset] = Layout::Locate(index);
+        return segments_[segment] + offset;
+    }
+
+    void AddSegment() {
+        if (num_segments_ == Layout::MAX_SEGMENTS) {
+            throw std::length_error("SegmentedVector: size exceeds MaxSize()");
+        }
+        if (segments_ == nullptr) {
+            TableAlloc table_alloc(alloc_);
+            segments_ = TableTraits::allocate(table_alloc, Layout::MAX_SEGMENTS);
+        }
+        const size_t count = Layout::SegmentSize(num_segments_);
+        segments_[num_segments_] = AllocTraits::allocate(alloc_, count);
+        Stats::OnAllocate(count);
+        ++num_segments_;
+    }
+
+    // Забирает сегменты other, аллокатор которого равен alloc_. Вектор должен быть пуст
+    void TakeSegments(SegmentedVector& other) noexcept {
+        assert(segments_ == nullptr);
+        segments_ = std::exchange(other.segments_, nullptr);
+        num_segments_ = std::exchange(other.num_segments_, 0);
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    // Заменяет элементы вектора count элементами, начиная с first: существующим
+    // элементам присваиваются новые значения, недостающие создаются, лишние разрушаются
+    template <typename InputIt>
+    void AssignN(InputIt first, size_t count) {
+        Reserve(count);
+        const size_t common = std::min(count, size_);
+        for (size_t i = 0; i != common; ++i, ++first) {
+            (*this)[i] = *first;
+        }
+        DestroyTail(common);
+        for (; size_ != count; ++first) {
+            EmplaceBack(*first);
+        }
+    }
+
+    // Разрушает элементы с индексами от new_size до конца
+    void DestroyTail(size_t new_size) noexcept {
+        while (size_ > new_size) {
+            --size_;
+            AllocTraits::destroy(alloc_, At(size_));
+        }
+    }
+};
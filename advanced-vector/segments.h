@@ -0,0 +1,47 @@
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <limits>
+
+namespace detail {
+
+// Разбиение индексов на сегменты удваивающегося размера: сегмент k вмещает
+// FIRST_SEGMENT << k элементов, а первые k сегментов вместе FIRST_SEGMENT * (2^k - 1).
+// Контейнер из таких сегментов растёт, добавляя сегмент, и никогда не переносит элементы
+template <size_t FIRST_SEGMENT_LOG2>
+struct SegmentLayout {
+    static constexpr size_t FIRST_SEGMENT = size_t{1} << FIRST_SEGMENT_LOG2;
+    static constexpr size_t MAX_SEGMENTS = std::numeric_limits<size_t>::digits - FIRST_SEGMENT_LOG2;
+    // Наибольшее число элементов, при котором индексы ещё не переполняются
+    static constexpr size_t MAX_SIZE = std::numeric_limits<size_t>::max() - FIRST_SEGMENT + 1;
+
+    struct Position {
+        size_t segment;
+        size_t offset;
+    };
+
+    static constexpr Position Locate(size_t index) noexcept {
+        assert(index < MAX_SIZE);
+        const size_t biased = index + FIRST_SEGMENT;
+        const size_t segment = static_cast<size_t>(std::bit_width(biased)) - 1 - FIRST_SEGMENT_LOG2;
+        return {segment, biased - (FIRST_SEGMENT << segment)};
+    }
+
+    static constexpr size_t SegmentSize(size_t segment) noexcept {
+        return FIRST_SEGMENT << segment;
+    }
+
+    // Индекс первого элемента сегмента
+    static constexpr size_t SegmentStart(size_t segment) noexcept {
+        return (FIRST_SEGMENT << segment) - FIRST_SEGMENT;
+    }
+
+    // Число сегментов, в которых помещается count элементов
+    static constexpr size_t SegmentsFor(size_t count) noexcept {
+        return count == 0 ? 0 : Locate(count - 1).segment + 1;
+    }
+};
+
+}  // namespace detail
@@ -0,0 +1,337 @@
+#pragma once
+
+#include "vector.h"
+
+// Вектор, хранящий до N элементов во встроенном буфере. Память в куче выделяется, только
+// когда элементы перестают помещаться в буфер, и после этого вектор ведёт себя как Vector.
+// Гарантии безопасности исключений совпадают с гарантиями Vector
+template <typename T, size_t N, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+class SmallVector {
+public:
+    static_assert(N > 0, "Встроенный буфер должен вмещать хотя бы один элемент");
+    static_assert(std::allocator_traits<Alloc>::is_always_equal::value,
+                  "SmallVector поддерживает только аллокаторы без состояния");
+
+    using iterator = T*;
+    using const_iterator = const T*;
+    using allocator_type = Alloc;
+
+    SmallVector() = default;
+
+    explicit SmallVector(size_t size) {
+        Reserve(size);
+        UninitializedValueConstructN(Data(), size);
+        size_ = size;
+    }
+
+    SmallVector(const SmallVector& other) {
+        Reserve(other.size_);
+        UninitializedCopyN(other.Data(), other.size_, Data());
+        size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        TakeFrom(other);
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        if (this != &rhs) {
+            AssignN(rhs.Data(), rhs.size_);
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            DestroyN(Data(), size_);
+            size_ = 0;
+            Memory empty;
+            heap_.Swap(empty);
+            TakeFrom(rhs);
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        DestroyN(Data(), size_);
+    }
+
+    iterator begin() noexcept {
+        return Data();
+    }
+    iterator end() noexcept {
+        return Data() + size_;
+    }
+    const_iterator begin() const noexcept {
+        return Data();
+    }
+    const_iterator end() const noexcept {
+        return Data() + size_;
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SmallVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    // Элементы размещаются во встроенном буфере
+    bool IsInline() const noexcept {
+        return heap_.GetAddress() == nullptr;
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        iterator nc_pos = const_cast<iterator>(pos);
+        if (size_ < Capacity()) {
+            return EmplaceWithinCapacity(nc_pos, std::forward<Args>(args)...);
+        }
+        return EmplaceReallocating(nc_pos - Data(), GrowthCapacity(size_ + 1), std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        return *Emplace(end(), std::forward<Args>(args)...);
+    }
+
+    iterator Erase(const_iterator pos) {
+        iterator nc_pos = const_cast<iterator>(pos);
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            Destroy(nc_pos);
+            Ops::MoveBytes(nc_pos, nc_pos + 1, end() - nc_pos - 1);
+        } else {
+            std::move(nc_pos + 1, end(), nc_pos);
+            Destroy(end() - 1);
+        }
+        --size_;
+        return nc_pos;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    void PopBack() noexcept {
+        Destroy(end() - 1);
+        --size_;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+
+        Stats::OnReallocate(Capacity());
+        Memory new_data(new_capacity);
+        Relocate(Data(), size_, new_data.GetAddress());
+        heap_.Swap(new_data);
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            DestroyN(Data() + new_size, size_ - new_size);
+            size_ = new_size;
+        } else if (new_size > size_) {
+            if (new_size > Capacity()) {
+                Reserve(GrowthCapacity(new_size));
+            }
+            UninitializedValueConstructN(Data() + size_, new_size - size_);
+            size_ = new_size;
+        }
+    }
+
+    void Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (!IsInline() && !other.IsInline()) {
+            heap_.Swap(other.heap_);
+            std::swap(size_, other.size_);
+        } else {
+            SmallVector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
+private:
+    using Memory = RawMemory<T, Alloc>;
+    using Ops = detail::ElementOps<T, Alloc>;
+    using TemporaryValue = detail::TemporaryValue<T, Alloc>;
+    using Stats = detail::StatsHooks<T>;
+
+    union InlineBuffer {
+        InlineBuffer() noexcept {
+        }
+        ~InlineBuffer() {
+        }
+        T values[N];
+    };
+
+    // Пуст, пока элементы помещаются во встроенный буфер
+    Memory heap_;
+    size_t size_ = 0;
+    InlineBuffer inline_;
+
+    T* Data() noexcept {
+        return IsInline() ? inline_.values : heap_.GetAddress();
+    }
+
+    const T* Data() const noexcept {
+        return const_cast<SmallVector&>(*this).Data();
+    }
+
+    // Забирает элементы other. Вектор должен быть пуст и не владеть памятью в куче
+    void TakeFrom(SmallVector& other) {
+        assert(size_ == 0 && IsInline());
+        if (!other.IsInline()) {
+            heap_.Swap(other.heap_);
+        } else {
+            Relocate(other.Data(), other.size_, inline_.values);
+        }
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    template <typename... Args>
+    iterator EmplaceWithinCapacity(iterator pos, Args&&... args) {
+        assert(size_ < Capacity());
+        if (pos == end()) {
+            Construct(end(), std::forward<Args>(args)...);
+        } else {
+            // Аргументы могут ссылаться на элементы вектора, поэтому значение
+            // создаётся до сдвига хвоста
+            TemporaryValue tmp(heap_.GetAllocator(), std::forward<Args>(args)...);
+            if constexpr (IsTriviallyRelocatableV<T>) {
+                Ops::MoveBytes(pos + 1, pos, end() - pos);
+                tmp.RelocateTo(pos);
+            } else {
+                Construct(end(), std::move(*(end() - 1)));
+                // Созданный элемент сразу входит в вектор: если сдвиг выбросит исключение,
+                // он будет разрушен вместе с остальными
+                ++size_;
+                std::move_backward(pos, end() - 2, end() - 1);
+                *pos = std::move(tmp.Get());
+                return pos;
+            }
+        }
+        ++size_;
+        return pos;
+    }
+
+    // Создаёт элемент в позиции index нового буфера в куче вместимостью new_capacity
+    // и переносит в этот буфер остальные элементы
+    template <typename... Args>
+    iterator EmplaceReallocating(size_t index, size_t new_capacity, Args&&... args) {
+        Stats::OnReallocate(Capacity());
+        Memory new_data(new_capacity);
+        T* new_data_pos = new_data.GetAddress() + index;
+        T* old_pos = Data() + index;
+        Construct(new_data_pos, std::forward<Args>(args)...);
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            Ops::CopyBytes(new_data.GetAddress(), Data(), index);
+            Ops::CopyBytes(new_data_pos + 1, old_pos, size_ - index);
+        } else {
+            try {
+                CopyOrMoveData(Data(), index, new_data.GetAddress());
+            } catch (...) {
+                Destroy(new_data_pos);
+                throw;
+            }
+
+            try {
+                CopyOrMoveData(old_pos, size_ - index, new_data_pos + 1);
+            } catch (...) {
+                DestroyN(new_data.GetAddress(), index + 1);
+                throw;
+            }
+            DestroyN(Data(), size_);
+        }
+
+        heap_.Swap(new_data);
+        ++size_;
+        return new_data_pos;
+    }
+
+    // Переносит n элементов из from в сырую память to и разрушает исходные.
+    // Если перенос выбросит исключение, исходные элементы остаются нетронутыми
+    void Relocate(T* from, size_t n, T* to) {
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            Ops::CopyBytes(to, from, n);
+        } else {
+            CopyOrMoveData(from, n, to);
+            DestroyN(from, n);
+        }
+    }
+
+    size_t GrowthCapacity(size_t required) const {
+        const size_t capacity = std::max(Growth::NextCapacity(Capacity(), required, sizeof(T)), required);
+        Stats::OnGrowth(required, capacity);
+        return capacity;
+    }
+
+    // Присваивает вектору n элементов, начиная с first, повторно используя
+    // уже созданные элементы и выделенную память
+    template <typename InputIt>
+    void AssignN(InputIt first, size_t n) {
+        if (n > Capacity()) {
+            Memory new_data(n);
+            UninitializedCopyN(first, n, new_data.GetAddress());
+            DestroyN(Data(), size_);
+            heap_.Swap(new_data);
+        } else {
+            Ops::AssignN(heap_.GetAllocator(), Data(), size_, first, n);
+        }
+        size_ = n;
+    }
+
+    void DestroyN(T* buf, size_t n) noexcept {
+        Ops::DestroyN(heap_.GetAllocator(), buf, n);
+    }
+
+    void CopyOrMoveData(T* begin, size_t size, T* end) {
+        Ops::CopyOrMoveData(heap_.GetAllocator(), begin, size, end);
+    }
+
+    void UninitializedValueConstructN(T* buf, size_t n) {
+        Ops::UninitializedValueConstructN(heap_.GetAllocator(), buf, n);
+    }
+
+    template <typename InputIt>
+    void UninitializedCopyN(InputIt first, size_t n, T* buf) {
+        Ops::UninitializedCopyN(heap_.GetAllocator(), first, n, buf);
+    }
+
+    template <typename... Args>
+    void Construct(T* buf, Args&&... args) {
+        Ops::Construct(heap_.GetAllocator(), buf, std::forward<Args>(args)...);
+    }
+
+    void Destroy(T* buf) noexcept {
+        Ops::Destroy(heap_.GetAllocator(), buf);
+    }
+};
@@ -0,0 +1,393 @@
+#pragma once
+
+#include "vector.h"
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Вектор записей, который хранит каждое поле в отдельном столбце (structure of arrays):
+// проход по одному полю читает только его байты. Все столбцы растут вместе по политике
+// Growth. Строка выдаётся как кортеж ссылок на поля, столбец как std::span.
+// Гарантии безопасности исключений совпадают с гарантиями Vector
+template <typename Growth, typename... Fields>
+class BasicSoAVector {
+    static_assert(sizeof...(Fields) > 0, "Нужен хотя бы один столбец");
+
+    template <bool IS_CONST>
+    class RowIterator;
+
+public:
+    static constexpr size_t NUM_COLUMNS = sizeof...(Fields);
+
+    template <size_t I>
+    using FieldType = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    using Row = std::tuple<Fields&...>;
+    using ConstRow = std::tuple<const Fields&...>;
+    using iterator = RowIterator<false>;
+    using const_iterator = RowIterator<true>;
+
+    BasicSoAVector() = default;
+
+    explicit BasicSoAVector(size_t size) {
+        Resize(size);
+    }
+
+    BasicSoAVector(const BasicSoAVector& other)
+    : columns_(Memory<Fields>(other.size_)...)
+    , capacity_(other.size_) {
+        size_t copied = 0;
+        try {
+            ForEachColumn([&](auto column) {
+                constexpr size_t I = column.value;
+                Ops<I>::UninitializedCopyN(Alloc<I>(columns_), other.Data<I>(), other.size_, Data<I>());
+                ++copied;
+            });
+        } catch (...) {
+            DestroyColumns(columns_, 0, other.size_, copied);
+            throw;
+        }
+        size_ = other.size_;
+    }
+
+    BasicSoAVector(BasicSoAVector&& other) noexcept
+    : columns_(std::move(other.columns_))
+    , capacity_(std::exchange(other.capacity_, 0))
+    , size_(std::exchange(other.size_, 0)) {
+    }
+
+    BasicSoAVector& operator=(const BasicSoAVector& rhs) {
+        if (this != &rhs) {
+            BasicSoAVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    BasicSoAVector& operator=(BasicSoAVector&& rhs) noexcept {
+        if (this != &rhs) {
+            BasicSoAVector moved(std::move(rhs));
+            Swap(moved);
+        }
+        return *this;
+    }
+
+    ~BasicSoAVector() {
+        DestroyColumns(columns_, 0, size_, NUM_COLUMNS);
+    }
+
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+    const_iterator begin() const noexcept {
+        return const_iterator(this, 0);
+    }
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    // Строка index как кортеж ссылок на её поля
+    Row operator[](size_t index) noexcept {
+        assert(index < size_);
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            return Row(Data<I>()[index]...);
+        }(COLUMN_INDICES);
+    }
+
+    ConstRow operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            return ConstRow(Data<I>()[index]...);
+        }(COLUMN_INDICES);
+    }
+
+    // Столбец I целиком
+    template <size_t I>
+    std::span<FieldType<I>> Column() noexcept {
+        return {Data<I>(), size_};
+    }
+
+    template <size_t I>
+    std::span<const FieldType<I>> Column() const noexcept {
+        return {Data<I>(), size_};
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return capacity_;
+    }
+
+    static constexpr size_t MaxSize() noexcept {
+        return std::numeric_limits<std::ptrdiff_t>::max() / std::max({sizeof(Fields)...});
+    }
+
+    // Добавляет строку, создавая поле I из args[I]. Аргументы могут ссылаться на
+    // элементы вектора. Если создание поля или перенос строк выбросит исключение,
+    // вектор останется прежним
+    template <typename... Args>
+        requires(sizeof...(Args) == NUM_COLUMNS)
+    Row EmplaceBack(Args&&... args) {
+        if (size_ < capacity_) {
+            ConstructRow(columns_, size_, std::forward<Args>(args)...);
+        } else {
+            const size_t new_capacity = GrowthCapacity(size_ + 1);
+            Columns new_columns{Memory<Fields>(new_capacity)...};
+            ConstructRow(new_columns, size_, std::forward<Args>(args)...);
+            try {
+                RelocateRows(new_columns);
+            } catch (...) {
+                DestroyColumns(new_columns, size_, 1, NUM_COLUMNS);
+                throw;
+            }
+            columns_.swap(new_columns);
+            capacity_ = new_capacity;
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PushBack(const Fields&... fields) {
+        EmplaceBack(fields...);
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        --size_;
+        DestroyColumns(columns_, size_, 1, NUM_COLUMNS);
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= capacity_) {
+            return;
+        }
+        if (new_capacity > MaxSize()) {
+            throw std::length_error("SoAVector: requested capacity exceeds MaxSize()");
+        }
+        Columns new_columns{Memory<Fields>(new_capacity)...};
+        RelocateRows(new_columns);
+        columns_.swap(new_columns);
+        capacity_ = new_capacity;
+    }
+
+    // Новые строки создаются со значениями по умолчанию. Если конструктор выбросит
+    // исключение, размер вектора не изменится
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            DestroyColumns(columns_, new_size, size_ - new_size, NUM_COLUMNS);
+            size_ = new_size;
+        } else if (new_size > size_) {
+            if (new_size > capacity_) {
+                Reserve(GrowthCapacity(new_size));
+            }
+            const size_t count = new_size - size_;
+            size_t constructed = 0;
+            try {
+                ForEachColumn([&](auto column) {
+                    constexpr size_t I = column.value;
+                    Ops<I>::UninitializedValueConstructN(Alloc<I>(columns_), Data<I>() + size_, count);
+                    ++constructed;
+                });
+            } catch (...) {
+                DestroyColumns(columns_, size_, count, constructed);
+                throw;
+            }
+            size_ = new_size;
+        }
+    }
+
+    // Удаляет все строки. При release == true освобождает и память
+    void Clear(bool release = true) noexcept {
+        DestroyColumns(columns_, 0, size_, NUM_COLUMNS);
+        size_ = 0;
+        if (release) {
+            Columns empty;
+            columns_.swap(empty);
+            capacity_ = 0;
+        }
+    }
+
+    void Swap(BasicSoAVector& other) noexcept {
+        columns_.swap(other.columns_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+    }
+
+private:
+    template <typename F>
+    using Memory = RawMemory<F>;
+    using Columns = std::tuple<Memory<Fields>...>;
+
+    template <size_t I>
+    using Ops = detail::ElementOps<FieldType<I>, std::allocator<FieldType<I>>>;
+
+    // Перенос элементов столбца I в новый буфер может выбросить исключение
+    template <size_t I>
+    static constexpr bool MAY_THROW_ON_RELOCATE =
+        !IsTriviallyRelocatableV<FieldType<I>> && !std::is_nothrow_move_constructible_v<FieldType<I>>;
+
+    static constexpr auto COLUMN_INDICES = std::index_sequence_for<Fields...>{};
+
+    Columns columns_;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+
+    // Вызывает fn(std::integral_constant<size_t, I>) для каждого столбца по порядку
+    template <typename Fn>
+    static void ForEachColumn(Fn&& fn) {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (fn(std::integral_constant<size_t, I>{}), ...);
+        }(COLUMN_INDICES);
+    }
+
+    template <size_t I>
+    FieldType<I>* Data() noexcept {
+        return std::get<I>(columns_).GetAddress();
+    }
+
+    template <size_t I>
+    const FieldType<I>* Data() const noexcept {
+        return std::get<I>(columns_).GetAddress();
+    }
+
+    template <size_t I>
+    static std::allocator<FieldType<I>>& Alloc(Columns& columns) noexcept {
+        return std::get<I>(columns).GetAllocator();
+    }
+
+    size_t GrowthCapacity(size_t required) const {
+        if (required > MaxSize()) {
+            throw std::length_error("SoAVector: requested size exceeds MaxSize()");
+        }
+        return std::clamp(Growth::NextCapacity(capacity_, required, (sizeof(Fields) + ...)), required, MaxSize());
+    }
+
+    // Создаёт поля строки index в столбцах columns. Если создание поля выбросит
+    // исключение, уже созданные поля строки разрушаются
+    template <typename... Args>
+    static void ConstructRow(Columns& columns, size_t index, Args&&... args) {
+        size_t constructed = 0;
+        try {
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                ((Ops<I>::Construct(Alloc<I>(columns), std::get<I>(columns).GetAddress() + index, std::forward<Args>(args)),
+                  ++constructed),
+                 ...);
+            }(COLUMN_INDICES);
+        } catch (...) {
+            DestroyColumns(columns, index, 1, constructed);
+            throw;
+        }
+    }
+
+    // Разрушает count строк, начиная с first, в первых num_columns столбцах
+    static void DestroyColumns(Columns& columns, size_t first, size_t count, size_t num_columns) noexcept {
+        ForEachColumn([&](auto column) {
+            constexpr size_t I = column.value;
+            if (I < num_columns) {
+                Ops<I>::DestroyN(Alloc<I>(columns), std::get<I>(columns).GetAddress() + first, count);
+            }
+        });
+    }
+
+    // Переносит все строки в new_columns. Сначала копируются столбцы, перенос которых
+    // может выбросить исключение: при ошибке их копии разрушаются, а исходные строки
+    // не тронуты. Остальные столбцы затем переносятся без исключений
+    void RelocateRows(Columns& new_columns) {
+        size_t copied = 0;
+        try {
+            ForEachColumn([&](auto column) {
+                constexpr size_t I = column.value;
+                if constexpr (MAY_THROW_ON_RELOCATE<I>) {
+                    Ops<I>::CopyOrMoveData(Alloc<I>(new_columns), Data<I>(), size_, std::get<I>(new_columns).GetAddress());
+                    ++copied;
+                }
+            });
+        } catch (...) {
+            size_t destroyed = 0;
+            ForEachColumn([&](auto column) {
+                constexpr size_t I = column.value;
+                if constexpr (MAY_THROW_ON_RELOCATE<I>) {
+                    if (destroyed++ < copied) {
+                        Ops<I>::DestroyN(Alloc<I>(new_columns), std::get<I>(new_columns).GetAddress(), size_);
+                    }
+                }
+            });
+            throw;
+        }
+
+        ForEachColumn([&](auto column) {
+            constexpr size_t I = column.value;
+            FieldType<I>* to = std::get<I>(new_columns).GetAddress();
+            if constexpr (IsTriviallyRelocatableV<FieldType<I>>) {
+                Ops<I>::CopyBytes(to, Data<I>(), size_);
+            } else {
+                if constexpr (!MAY_THROW_ON_RELOCATE<I>) {
+                    Ops<I>::CopyOrMoveData(Alloc<I>(new_columns), Data<I>(), size_, to);
+                }
+                Ops<I>::DestroyN(Alloc<I>(columns_), Data<I>(), size_);
+            }
+        });
+    }
+
+    // Итератор по строкам. Разыменование даёт кортеж ссылок, поэтому итератор
+    // годится для range-based for и структурных привязок, но не для std::sort
+    template <bool IS_CONST>
+    class RowIterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::tuple<Fields...>;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<IS_CONST, ConstRow, Row>;
+
+        RowIterator() = default;
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        RowIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        RowIterator operator++(int) noexcept {
+            RowIterator old = *this;
+            ++index_;
+            return old;
+        }
+
+        bool operator==(const RowIterator& other) const noexcept {
+            return index_ == other.index_;
+        }
+
+    private:
+        friend class BasicSoAVector;
+        using Owner = std::conditional_t<IS_CONST, const BasicSoAVector, BasicSoAVector>;
+
+        RowIterator(Owner* owner, size_t index) noexcept
+        : owner_(owner)
+        , index_(index) {
+        }
+
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+};
+
+template <typename... Fields>
+using SoAVector = BasicSoAVector<DoublingGrowth, Fields...>;
@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Вектор вместимостью не более N элементов, которые хранятся в самом объекте:
+// динамическая память не выделяется никогда. Интерфейс повторяет Vector; операции,
+// которым не хватает места, выбрасывают std::length_error, а TryEmplaceBack вместо
+// этого возвращает nullptr. Для тривиальных типов (тривиально копируемых и создаваемых
+// по умолчанию) StaticVector сам тривиально копируем и работает в constexpr, поэтому
+// подходит для таблиц, которые строятся во время компиляции
+template <typename T, size_t N>
+class StaticVector {
+    static_assert(N > 0, "Вместимость StaticVector должна быть положительной");
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    // Элементы хранятся в обычном массиве, и вектор работает в constexpr
+    static constexpr bool IS_TRIVIAL = std::is_trivially_default_constructible_v<T> && std::is_trivially_copyable_v<T>;
+
+    constexpr StaticVector() noexcept = default;
+
+    constexpr explicit StaticVector(size_t size) {
+        Resize(size);
+    }
+
+    constexpr StaticVector(std::initializer_list<T> values) {
+        if (values.size() > N) {
+            throw std::length_error("StaticVector: too many elements");
+        }
+        for (const T& value : values) {
+            EmplaceBack(value);
+        }
+    }
+
+    constexpr StaticVector(const StaticVector&) requires IS_TRIVIAL = default;
+
+    constexpr StaticVector(const StaticVector& other) {
+        for (const T& value : other) {
+            EmplaceBack(value);
+        }
+    }
+
+    constexpr StaticVector(StaticVector&&) requires IS_TRIVIAL = default;
+
+    constexpr StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        for (T& value : other) {
+            EmplaceBack(std::move(value));
+        }
+        other.Clear();
+    }
+
+    constexpr StaticVector& operator=(const StaticVector&) requires IS_TRIVIAL = default;
+
+    constexpr StaticVector& operator=(const StaticVector& rhs) {
+        if (this != &rhs) {
+            Assign(rhs.begin(), rhs.end());
+        }
+        return *this;
+    }
+
+    constexpr StaticVector& operator=(StaticVector&&) requires IS_TRIVIAL = default;
+
+    constexpr StaticVector& operator=(StaticVector&& rhs) noexcept(std::is_nothrow_move_assignable_v<T>
+                                                                   && std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            Assign(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+            rhs.Clear();
+        }
+        return *this;
+    }
+
+    constexpr ~StaticVector() requires IS_TRIVIAL = default;
+
+    constexpr ~StaticVector() {
+        Clear();
+    }
+
+    constexpr iterator begin() noexcept {
+        return Data();
+    }
+    constexpr iterator end() noexcept {
+        return Data() + size_;
+    }
+    constexpr const_iterator begin() const noexcept {
+        return Data();
+    }
+    constexpr const_iterator end() const noexcept {
+        return Data() + size_;
+    }
+    constexpr const_iterator cbegin() const noexcept {
+        return begin();
+    }
+    constexpr const_iterator cend() const noexcept {
+        return end();
+    }
+
+    constexpr const T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    constexpr T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    constexpr size_t Size() const noexcept {
+        return size_;
+    }
+
+    static constexpr size_t Capacity() noexcept {
+        return N;
+    }
+
+    constexpr std::span<T> AsSpan() noexcept {
+        return {Data(), size_};
+    }
+
+    constexpr std::span<const T> AsSpan() const noexcept {
+        return {Data(), size_};
+    }
+
+    // Добавляет элемент, если для него есть место, иначе возвращает nullptr
+    template <typename... Args>
+    constexpr T* TryEmplaceBack(Args&&... args) {
+        if (size_ == N) {
+            return nullptr;
+        }
+        T* slot = std::construct_at(Data() + size_, std::forward<Args>(args)...);
+        ++size_;
+        return slot;
+    }
+
+    template <typename... Args>
+    constexpr T& EmplaceBack(Args&&... args) {
+        if (T* slot = TryEmplaceBack(std::forward<Args>(args)...)) {
+            return *slot;
+        }
+        throw std::length_error("StaticVector: capacity exceeded");
+    }
+
+    constexpr void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    constexpr void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    constexpr void PopBack() noexcept {
+        assert(size_ != 0);
+        --size_;
+        std::destroy_at(Data() + size_);
+    }
+
+    // Аргументы могут ссылаться на элементы вектора
+    template <typename... Args>
+    constexpr iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(pos >= begin() && pos <= end());
+        const size_t index = pos - begin();
+        if (size_ == N) {
+            throw std::length_error("StaticVector: capacity exceeded");
+        }
+        if (index == size_) {
+            return &EmplaceBack(std::forward<Args>(args)...);
+        }
+        T value(std::forward<Args>(args)...);
+        std::construct_at(end(), std::move(Data()[size_ - 1]));
+        ++size_;
+        std::move_backward(begin() + index, end() - 2, end() - 1);
+        Data()[index] = std::move(value);
+        return begin() + index;
+    }
+
+    constexpr iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    constexpr iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    constexpr iterator Erase(const_iterator pos) {
+        return Erase(pos, pos + 1);
+    }
+
+    constexpr iterator Erase(const_iterator first, const_iterator last) {
+        assert(first >= begin() && first <= last && last <= end());
+        iterator nc_first = begin() + (first - cbegin());
+        iterator new_end = std::move(nc_first + (last - first), end(), nc_first);
+        DestroyTail(new_end - begin());
+        return nc_first;
+    }
+
+    template <typename InputIt>
+    constexpr void Assign(InputIt first, InputIt last) {
+        size_t i = 0;
+        for (; first != last && i != size_; ++first, ++i) {
+            Data()[i] = *first;
+        }
+        DestroyTail(i);
+        for (; first != last; ++first) {
+            EmplaceBack(*first);
+        }
+    }
+
+    // Если конструктор нового элемента выбросит исключение, размер вектора не изменится
+    constexpr void Resize(size_t new_size) {
+        if (new_size > N) {
+            throw std::length_error("StaticVector: requested size exceeds capacity");
+        }
+        if (new_size < size_) {
+            DestroyTail(new_size);
+            return;
+        }
+        const size_t old_size = size_;
+        try {
+            while (size_ < new_size) {
+                EmplaceBack();
+            }
+        } catch (...) {
+            DestroyTail(old_size);
+            throw;
+        }
+    }
+
+    constexpr void Clear() noexcept {
+        DestroyTail(0);
+    }
+
+    constexpr void Swap(StaticVector& other) noexcept(std::is_nothrow_swappable_v<T>
+                                                      && std::is_nothrow_move_constructible_v<T>) {
+        StaticVector& longer = size_ >= other.size_ ? *this : other;
+        StaticVector& shorter = size_ >= other.size_ ? other : *this;
+        const size_t common = shorter.size_;
+        std::swap_ranges(longer.begin(), longer.begin() + common, shorter.begin());
+        for (size_t i = common; i != longer.size_; ++i) {
+            shorter.EmplaceBack(std::move(longer.Data()[i]));
+        }
+        longer.DestroyTail(common);
+    }
+
+private:
+    // Массив для тривиальных типов, иначе объединение, в котором элементы создаются по одному.
+    // Во время выполнения массив не заполняется, чтобы создание вектора не стоило O(N).
+    // При вычислении константных выражений все ячейки должны быть инициализированы,
+    // поэтому только тогда они заполняются значениями по умолчанию
+    struct TrivialStorage {
+        constexpr TrivialStorage() noexcept {
+            if (std::is_constant_evaluated()) {
+                for (T& value : values) {
+                    std::construct_at(&value);
+                }
+            }
+        }
+        T values[N];
+    };
+
+    union ObjectStorage {
+        constexpr ObjectStorage() noexcept {
+        }
+        constexpr ~ObjectStorage() {
+        }
+        T values[N];
+    };
+
+    std::conditional_t<IS_TRIVIAL, TrivialStorage, ObjectStorage> storage_;
+    size_t size_ = 0;
+
+    constexpr T* Data() noexcept {
+        return storage_.values;
+    }
+
+    constexpr const T* Data() const noexcept {
+        return storage_.values;
+    }
+
+    // Разрушает элементы с индексами от new_size до конца
+    constexpr void DestroyTail(size_t new_size) noexcept {
+        while (size_ > new_size) {
+            --size_;
+            std::destroy_at(Data() + size_);
+        }
+    }
+};
+
+template <typename T, size_t N>
+constexpr bool operator==(const StaticVector<T, N>& lhs, const StaticVector<T, N>& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename T, size_t N>
+    requires std::three_way_comparable<T>
+constexpr std::compare_three_way_result_t<T> operator<=>(const StaticVector<T, N>& lhs,
+                                                         const StaticVector<T, N>& rhs) {
+    return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
@@ -2,322 +2,1454 @@
 
 #include <algorithm>
 #include <cassert>
+#include <compare>
+#include <concepts>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
 #include <memory>
+#include <memory_resource>
 #include <new>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 
+#include "vector_stats.h"
+
+// Тип тривиально перемещаем, если перенос объекта на новое место побайтовым копированием
+// (после которого старый объект просто забывается, без вызова деструктора) равносилен
+// перемещению с последующим разрушением оригинала. Такие элементы Vector переносит
+// через memcpy/memmove. Собственные типы подключаются специализацией шаблона:
+//   template <> struct IsTriviallyRelocatable<MyHandle> : std::true_type {};
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename T, typename Deleter>
+struct IsTriviallyRelocatable<std::unique_ptr<T, Deleter>> : IsTriviallyRelocatable<Deleter> {};
+
 template <typename T>
+inline constexpr bool IsTriviallyRelocatableV = IsTriviallyRelocatable<T>::value;
+
+template <typename T, typename Alloc = std::allocator<T>>
 class RawMemory {
 public:
-    RawMemory() = default;
+    using allocator_type = Alloc;
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+                  "Тип элементов аллокатора должен совпадать с T");
+    static_assert(std::is_same_v<typename AllocTraits::pointer, T*>,
+                  "Поддерживаются только аллокаторы с обычными указателями");
+
+    // Аллокатор умеет расширять блок памяти, не перемещая его:
+    //   bool expand_in_place(T* p, size_t old_n, size_t new_n)
+    static constexpr bool CAN_EXPAND_IN_PLACE = requires(Alloc& alloc, T* p, size_t n) {
+        { alloc.expand_in_place(p, n, n) } -> std::convertible_to<bool>;
+    };
 
-    explicit RawMemory(size_t capacity)
-    : buffer_(Allocate(capacity))
+    // Аллокатор умеет перевыделять блок с сохранением его байтов, как realloc:
+    //   T* reallocate(T* p, size_t old_n, size_t new_n)
+    static constexpr bool CAN_REALLOCATE = requires(Alloc& alloc, T* p, size_t n) {
+        { alloc.reallocate(p, n, n) } -> std::same_as<T*>;
+    };
+
+    constexpr RawMemory() = default;
+
+    constexpr explicit RawMemory(const Alloc& alloc) noexcept
+    : alloc_(alloc) {
+    }
+
+    // Аллокатор сообщает, сколько элементов на самом деле поместится в выделенный блок:
+    //   auto [ptr, count] = allocate_at_least(n)
+    static constexpr bool CAN_ALLOCATE_AT_LEAST = requires(Alloc& alloc, size_t n) {
+        { alloc.allocate_at_least(n).ptr } -> std::convertible_to<T*>;
+        { alloc.allocate_at_least(n).count } -> std::convertible_to<size_t>;
+    };
+
+    // Выравнивание буфера. Аллокатор может гарантировать большее, чем alignof(T):
+    //   static constexpr size_t alignment
+    static constexpr size_t ALIGNMENT = [] {
+        if constexpr (requires { Alloc::alignment; }) {
+            return std::max<size_t>(Alloc::alignment, alignof(T));
+        } else {
+            return alignof(T);
+        }
+    }();
+
+    // Выделяет память не менее чем под capacity элементов. Если аллокатор умеет
+    // allocate_at_least, весь запас выделенного блока входит во вместимость
+    constexpr explicit RawMemory(size_t capacity, const Alloc& alloc = Alloc())
+    : alloc_(alloc) {
+        if constexpr (CAN_ALLOCATE_AT_LEAST) {
+            if (std::is_constant_evaluated()) {
+                buffer_ = Allocate(capacity);
+                capacity_ = capacity;
+            } else if (capacity != 0) {
+                auto [ptr, count] = alloc_.allocate_at_least(capacity);
+                buffer_ = ptr;
+                capacity_ = count;
+            }
+        } else {
+            buffer_ = Allocate(capacity);
+            capacity_ = capacity;
+        }
+        if (buffer_ != nullptr) {
+            Stats::OnAllocate(capacity_);
+        }
+    }
+
+    // Принимает во владение буфер вместимостью capacity, выделенный аллокатором alloc
+    constexpr RawMemory(T* buffer, size_t capacity, const Alloc& alloc) noexcept
+    : alloc_(alloc)
+    , buffer_(buffer)
     , capacity_(capacity) {
+        if (buffer_ != nullptr) {
+            Stats::OnAllocate(capacity_);
+        }
     }
 
     RawMemory(const RawMemory&) = delete;
     RawMemory& operator=(const RawMemory& rhs) = delete;
 
-    RawMemory(RawMemory&& other) noexcept {
+    constexpr RawMemory(RawMemory&& other) noexcept
+    : alloc_(std::move(other.alloc_)) {
         buffer_ = std::exchange(other.buffer_, nullptr);
         capacity_ = std::exchange(other.capacity_,0);
     }
 
-    RawMemory& operator=(RawMemory&& rhs) noexcept {
+    // Забирает буфер rhs вместе с его аллокатором: память должна вернуться туда,
+    // откуда была получена. Решение о propagate_on_container_* принимает контейнер
+    constexpr RawMemory& operator=(RawMemory&& rhs) noexcept {
         if(this != &rhs) {
-            Deallocate(buffer_);
+            Deallocate(buffer_, capacity_);
+            alloc_ = std::move(rhs.alloc_);
             buffer_ = std::exchange(rhs.buffer_, nullptr);
             capacity_ = std::exchange(rhs.capacity_,0);
         }
         return *this;
     }
 
-    ~RawMemory() {
-        Deallocate(buffer_);
+    constexpr ~RawMemory() {
+        Deallocate(buffer_, capacity_);
     }
 
-    T* operator+(size_t offset) noexcept {
+    constexpr T* operator+(size_t offset) noexcept {
         // Разрешается получать адрес ячейки памяти, следующей за последним элементом массива
         assert(offset <= capacity_);
         return buffer_ + offset;
     }
 
-    const T* operator+(size_t offset) const noexcept {
+    constexpr const T* operator+(size_t offset) const noexcept {
         return const_cast<RawMemory&>(*this) + offset;
     }
 
-    const T& operator[](size_t index) const noexcept {
+    constexpr const T& operator[](size_t index) const noexcept {
         return const_cast<RawMemory&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    constexpr T& operator[](size_t index) noexcept {
         assert(index < capacity_);
         return buffer_[index];
     }
 
-    void Swap(RawMemory& other) noexcept {
+    // Аллокаторы обмениваются, только если это разрешает propagate_on_container_swap,
+    // иначе аллокаторы обоих объектов должны быть равны
+    constexpr void Swap(RawMemory& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(AllocTraits::is_always_equal::value || alloc_ == other.alloc_);
+        }
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
     }
 
-    const T* GetAddress() const noexcept {
+    constexpr const T* GetAddress() const noexcept {
         return buffer_;
     }
 
-    T* GetAddress() noexcept {
+    constexpr T* GetAddress() noexcept {
         return buffer_;
     }
 
-    size_t Capacity() const {
+    constexpr size_t Capacity() const {
         return capacity_;
     }
 
+    constexpr const Alloc& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    constexpr Alloc& GetAllocator() noexcept {
+        return alloc_;
+    }
+
+    // Отдаёт буфер вызывающему, который становится ответственным за его освобождение
+    constexpr T* Release() noexcept {
+        if (buffer_ != nullptr) {
+            Stats::OnDeallocate(capacity_);
+        }
+        capacity_ = 0;
+        return std::exchange(buffer_, nullptr);
+    }
+
+    // Пытается увеличить вместимость до new_capacity, не перемещая буфер
+    constexpr bool TryExpandInPlace(size_t new_capacity) {
+        if constexpr (CAN_EXPAND_IN_PLACE) {
+            if (!std::is_constant_evaluated() && buffer_ != nullptr && alloc_.expand_in_place(buffer_, capacity_, new_capacity)) {
+                Stats::OnResizeBuffer(capacity_, new_capacity);
+                capacity_ = new_capacity;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Перевыделяет буфер под new_capacity элементов с сохранением его содержимого.
+    // Объекты переносятся побайтово, поэтому T должен быть тривиально перемещаемым.
+    // При ошибке буфер остаётся прежним
+    constexpr void Reallocate(size_t new_capacity) {
+        static_assert(CAN_REALLOCATE && IsTriviallyRelocatableV<T>);
+        buffer_ = alloc_.reallocate(buffer_, capacity_, new_capacity);
+        Stats::OnResizeBuffer(capacity_, new_capacity);
+        capacity_ = new_capacity;
+    }
+
 private:
-    // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    using Stats = detail::StatsHooks<T>;
+
+    // Выделяет сырую память под n элементов и возвращает указатель на неё.
+    // При вычислении константных выражений память выделяет std::allocator: только
+    // его выделения допустимы в constexpr, и освобождает их тоже он
+    constexpr T* Allocate(size_t n) {
+        if (n == 0) {
+            return nullptr;
+        }
+        if (std::is_constant_evaluated()) {
+            return std::allocator<T>().allocate(n);
+        }
+        return AllocTraits::allocate(alloc_, n);
     }
 
-    // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    // Освобождает сырую память под n элементов, выделенную ранее по адресу buf при помощи Allocate
+    constexpr void Deallocate(T* buf, size_t n) noexcept {
+        if (buf != nullptr) {
+            Stats::OnDeallocate(n);
+            if (std::is_constant_evaluated()) {
+                std::allocator<T>().deallocate(buf, n);
+            } else {
+                AllocTraits::deallocate(alloc_, buf, n);
+            }
+        }
     }
 
+    // Пустой аллокатор не увеличивает размер RawMemory
+    [[no_unique_address]] Alloc alloc_;
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
 };
 
 
+namespace detail {
+
+// Аллокатор не переопределяет создание копий T, поэтому копию можно получить memcpy.
+// polymorphic_allocator создаёт объекты сам, только если T использует аллокатор
+template <typename Alloc, typename T>
+inline constexpr bool PLAIN_CONSTRUCT = !requires(Alloc& alloc, T* buf, const T& value) {
+    alloc.construct(buf, value);
+};
+
+template <typename U, typename T>
+inline constexpr bool PLAIN_CONSTRUCT<std::pmr::polymorphic_allocator<U>, T> =
+    !std::uses_allocator_v<T, std::pmr::polymorphic_allocator<U>>;
+
+// Аллокатор не переопределяет разрушение T
+template <typename Alloc, typename T>
+inline constexpr bool PLAIN_DESTROY = !requires(Alloc& alloc, T* buf) { alloc.destroy(buf); };
+
+template <typename U, typename T>
+inline constexpr bool PLAIN_DESTROY<std::pmr::polymorphic_allocator<U>, T> = true;
+
+// Операции над элементами в сырой памяти. Объекты создаются и разрушаются при помощи аллокатора
+template <typename T, typename Alloc>
+struct ElementOps {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    // Копирование и присваивание элементов выполняются одним memcpy
+    static constexpr bool BITWISE_COPY = std::is_trivially_copyable_v<T> && std::is_trivially_copy_constructible_v<T>
+                                         && std::is_trivially_copy_assignable_v<T> && PLAIN_CONSTRUCT<Alloc, T>;
+    static constexpr bool BITWISE_MOVE = BITWISE_COPY && std::is_trivially_move_constructible_v<T>;
+    // Разрушение элементов ничего не делает
+    static constexpr bool TRIVIAL_DESTROY = std::is_trivially_destructible_v<T> && PLAIN_DESTROY<Alloc, T>;
+
+    // Элементы диапазона, начинающегося с It, копируются memcpy
+    template <typename It>
+    static constexpr bool COPIES_BYTES_FROM =
+        BITWISE_COPY && std::contiguous_iterator<It>
+        && std::is_same_v<std::remove_cvref_t<std::iter_reference_t<It>>, T>;
+
+    // Создаёт объект в сырой памяти по адресу buf. При вычислении константных выражений
+    // объекты создаются и разрушаются напрямую, как и память берётся у std::allocator
+    template <typename... Args>
+    static constexpr void Construct(Alloc& alloc, T* buf, Args&&... args) {
+        if (std::is_constant_evaluated()) {
+            std::construct_at(buf, std::forward<Args>(args)...);
+        } else {
+            AllocTraits::construct(alloc, buf, std::forward<Args>(args)...);
+        }
+    }
+
+    // Вызывает деструктор объекта по адресу buf
+    static constexpr void Destroy(Alloc& alloc, T* buf) noexcept {
+        if (std::is_constant_evaluated()) {
+            std::destroy_at(buf);
+        } else {
+            AllocTraits::destroy(alloc, buf);
+        }
+    }
+
+    static constexpr void DestroyN(Alloc& alloc, T* buf, size_t n) noexcept {
+        if constexpr (!TRIVIAL_DESTROY) {
+            for (size_t i = 0; i != n; ++i) {
+                Destroy(alloc, buf + i);
+            }
+        }
+    }
+
+    // Создаёт n элементов со значением по умолчанию в сырой памяти по адресу buf.
+    // Если конструктор выбросит исключение, уже созданные элементы разрушаются
+    static constexpr void UninitializedValueConstructN(Alloc& alloc, T* buf, size_t n) {
+        size_t i = 0;
+        try {
+            for (; i != n; ++i) {
+                Construct(alloc, buf + i);
+            }
+        } catch (...) {
+            DestroyN(alloc, buf, i);
+            throw;
+        }
+    }
+
+    // Создаёт n элементов в сырой памяти по адресу buf инициализацией по умолчанию:
+    // тривиальные типы остаются неинициализированными. Если аллокатор сам создаёт
+    // объекты (construct), элементы создаются им со значением по умолчанию.
+    // polymorphic_allocator не вмешивается в создание T, не использующих аллокатор
+    static constexpr void UninitializedDefaultConstructN(Alloc& alloc, T* buf, size_t n) {
+        if constexpr (requires { alloc.construct(buf); } && !PLAIN_CONSTRUCT<Alloc, T>) {
+            UninitializedValueConstructN(alloc, buf, n);
+        } else {
+            size_t i = 0;
+            try {
+                for (; i != n; ++i) {
+                    if (std::is_constant_evaluated()) {
+                        std::construct_at(buf + i);
+                    } else {
+                        ::new (static_cast<void*>(buf + i)) T;
+                    }
+                }
+            } catch (...) {
+                DestroyN(alloc, buf, i);
+                throw;
+            }
+        }
+    }
+
+    // Создаёт в сырой памяти по адресу buf копии n элементов, начиная с first
+    template <typename InputIt>
+    static constexpr void UninitializedCopyN(Alloc& alloc, InputIt first, size_t n, T* buf) {
+        if constexpr (COPIES_BYTES_FROM<InputIt>) {
+            CopyValues(buf, std::to_address(first), n);
+        } else {
+            size_t i = 0;
+            try {
+                for (; i != n; ++i, ++first) {
+                    Construct(alloc, buf + i, *first);
+                }
+            } catch (...) {
+                DestroyN(alloc, buf, i);
+                throw;
+            }
+        }
+    }
+
+    static constexpr void UninitializedMoveN(Alloc& alloc, T* first, size_t n, T* buf) {
+        if constexpr (BITWISE_MOVE) {
+            CopyValues(buf, first, n);
+        } else {
+            UninitializedCopyN(alloc, std::make_move_iterator(first), n, buf);
+        }
+    }
+
+    // Присваивает n элементов, начиная с first, size элементам по адресу buf. Недостающие
+    // элементы создаются в сырой памяти за ними, лишние разрушаются. Вместимости должно хватать
+    template <typename InputIt>
+    static constexpr void AssignN(Alloc& alloc, T* buf, size_t size, InputIt first, size_t n) {
+        if constexpr (COPIES_BYTES_FROM<InputIt>) {
+            if (size > n) {
+                DestroyN(alloc, buf + n, size - n);
+            }
+            CopyValues(buf, std::to_address(first), n);
+        } else if (size > n) {
+            std::copy_n(first, n, buf);
+            DestroyN(alloc, buf + n, size - n);
+        } else {
+            for (size_t i = 0; i != size; ++i, ++first) {
+                buf[i] = *first;
+            }
+            UninitializedCopyN(alloc, first, n - size, buf + size);
+        }
+    }
+
+    // Перемещает элементы, если перемещение не выбрасывает исключений, иначе копирует их,
+    // чтобы при ошибке исходные элементы остались нетронутыми
+    static constexpr void CopyOrMoveData(Alloc& alloc, T* begin, size_t size, T* end) {
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+            UninitializedMoveN(alloc, begin, size, end);
+            StatsHooks<T>::OnMove(size);
+        } else {
+            UninitializedCopyN(alloc, begin, size, end);
+            StatsHooks<T>::OnCopy(size);
+        }
+    }
+
+    // Копирует значения n элементов побайтово. Это копирование, а не перенос элементов,
+    // поэтому в статистике оно не учитывается. Области памяти могут пересекаться
+    static constexpr void CopyValues(T* to, const T* from, size_t n) noexcept {
+        if (std::is_constant_evaluated()) {
+            // memmove в constexpr недоступен
+            for (size_t i = 0; i != n; ++i) {
+                std::construct_at(to + i, from[i]);
+            }
+        } else if (n != 0) {
+            std::memmove(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+        }
+    }
+
+    // Побайтово копирует n элементов в непересекающуюся область памяти
+    static constexpr void CopyBytes(T* to, const T* from, size_t n) noexcept {
+        if (std::is_constant_evaluated()) {
+            RelocateEach(to, const_cast<T*>(from), n, false);
+        } else if (n != 0) {
+            std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+            StatsHooks<T>::OnRelocate(n);
+        }
+    }
+
+    // Побайтово переносит n элементов, области памяти могут пересекаться
+    static constexpr void MoveBytes(T* to, const T* from, size_t n) noexcept {
+        if (std::is_constant_evaluated()) {
+            RelocateEach(to, const_cast<T*>(from), n, to > from);
+        } else if (n != 0) {
+            std::memmove(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+            StatsHooks<T>::OnRelocate(n);
+        }
+    }
+
+    // Перенос для constexpr, где побайтовое копирование недоступно: каждый элемент
+    // перемещается на новое место, а оригинал разрушается. При backward элементы
+    // переносятся начиная с последнего
+    static constexpr void RelocateEach(T* to, T* from, size_t n, bool backward) noexcept {
+        for (size_t k = 0; k != n; ++k) {
+            const size_t i = backward ? n - 1 - k : k;
+            std::construct_at(to + i, std::move(from[i]));
+            std::destroy_at(from + i);
+        }
+    }
+};
+
+// Итератор, count раз повторяющий одно и то же значение
 template <typename T>
+class RepeatIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    constexpr RepeatIterator() = default;
+
+    constexpr explicit RepeatIterator(const T& value, difference_type count = 0) noexcept
+    : value_(&value)
+    , count_(count) {
+    }
+
+    constexpr reference operator*() const noexcept {
+        return *value_;
+    }
+
+    constexpr RepeatIterator& operator++() noexcept {
+        ++count_;
+        return *this;
+    }
+
+    constexpr RepeatIterator operator++(int) noexcept {
+        RepeatIterator old = *this;
+        ++count_;
+        return old;
+    }
+
+    constexpr bool operator==(const RepeatIterator& other) const noexcept {
+        return count_ == other.count_;
+    }
+
+private:
+    const T* value_ = nullptr;
+    difference_type count_ = 0;
+};
+
+// Значение, созданное аллокатором контейнера вне его буфера. Нужно, когда аргументы
+// для создания элемента могут ссылаться на элементы самого контейнера
+template <typename T, typename Alloc>
+class TemporaryValue {
+public:
+    template <typename... Args>
+    constexpr explicit TemporaryValue(Alloc& alloc, Args&&... args)
+    : alloc_(alloc) {
+        ElementOps<T, Alloc>::Construct(alloc_, &slot_.value, std::forward<Args>(args)...);
+    }
+
+    TemporaryValue(const TemporaryValue&) = delete;
+    TemporaryValue& operator=(const TemporaryValue&) = delete;
+
+    constexpr ~TemporaryValue() {
+        if (!relocated_) {
+            ElementOps<T, Alloc>::Destroy(alloc_, &slot_.value);
+        }
+    }
+
+    constexpr T& Get() noexcept {
+        return slot_.value;
+    }
+
+    // Побайтово переносит значение в сырую память по адресу buf. Доступно только
+    // для тривиально перемещаемых T
+    constexpr void RelocateTo(T* buf) noexcept {
+        static_assert(IsTriviallyRelocatableV<T>);
+        ElementOps<T, Alloc>::CopyBytes(buf, &slot_.value, 1);
+        relocated_ = true;
+    }
+
+private:
+    union Slot {
+        constexpr Slot() noexcept {
+        }
+        constexpr ~Slot() {
+        }
+        T value;
+    };
+
+    Alloc& alloc_;
+    Slot slot_;
+    bool relocated_ = false;
+};
+
+// Равенство значений типа равносильно равенству их байтов, поэтому
+// диапазоны таких элементов сравниваются на равенство через memcmp
+template <typename T>
+inline constexpr bool IS_BITWISE_COMPARABLE = std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>;
+
+// Байты без знака: лексикографический порядок совпадает с порядком memcmp
+template <typename T>
+inline constexpr bool IS_UNSIGNED_BYTE =
+    sizeof(T) == 1 && (std::is_same_v<T, std::byte> || (std::is_integral_v<T> && std::is_unsigned_v<T>));
+
+inline uint64_t HashMix(uint64_t a, uint64_t b) noexcept {
+    const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+inline uint64_t HashRead8(const unsigned char* p) noexcept {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t HashRead4(const unsigned char* p) noexcept {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// Хеш байтов в духе wyhash: длинные данные обрабатываются блоками по 48 байт в трёх
+// независимых цепочках умножений, которые процессор выполняет параллельно.
+// Результат зависит от порядка байтов платформы и не предназначен для хранения
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0) noexcept {
+    static constexpr uint64_t SECRET[4] = {0x2d358dccaa6c78a5, 0x8bb84b93962eacc9, 0x4b33a62ed433d4a3,
+                                           0x4d5a2da51de1aa47};
+    const auto* p = static_cast<const unsigned char*>(data);
+    seed ^= HashMix(seed ^ SECRET[0], SECRET[1]);
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (size <= 16) {
+        if (size >= 4) {
+            const size_t shift = (size >> 3) << 2;
+            a = (HashRead4(p) << 32) | HashRead4(p + shift);
+            b = (HashRead4(p + size - 4) << 32) | HashRead4(p + size - 4 - shift);
+        } else if (size > 0) {
+            a = (uint64_t{p[0]} << 16) | (uint64_t{p[size >> 1]} << 8) | p[size - 1];
+        }
+    } else {
+        size_t rest = size;
+        if (rest > 48) {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+            do {
+                seed = HashMix(HashRead8(p) ^ SECRET[1], HashRead8(p + 8) ^ seed);
+                see1 = HashMix(HashRead8(p + 16) ^ SECRET[2], HashRead8(p + 24) ^ see1);
+                see2 = HashMix(HashRead8(p + 32) ^ SECRET[3], HashRead8(p + 40) ^ see2);
+                p += 48;
+                rest -= 48;
+            } while (rest > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (rest > 16) {
+            seed = HashMix(HashRead8(p) ^ SECRET[1], HashRead8(p + 8) ^ seed);
+            p += 16;
+            rest -= 16;
+        }
+        a = HashRead8(p + rest - 16);
+        b = HashRead8(p + rest - 8);
+    }
+    const unsigned __int128 product = static_cast<unsigned __int128>(a ^ SECRET[1]) * (b ^ seed);
+    return HashMix(static_cast<uint64_t>(product) ^ SECRET[0] ^ size, static_cast<uint64_t>(product >> 64) ^ SECRET[1]);
+}
+
+}  // namespace detail
+
+// Политики роста задают вместимость, до которой Vector увеличивает буфер, когда
+// элементы в него больше не помещаются:
+//   static size_t NextCapacity(size_t capacity, size_t required, size_t element_size)
+// Результат меньше required Vector не использует.
+// Явный Reserve политику не применяет и выделяет ровно запрошенное.
+
+// Удвоение вместимости
+struct DoublingGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        if (capacity == 0) {
+            return std::max<size_t>(required, 1);
+        }
+        return capacity > std::numeric_limits<size_t>::max() / 2 ? required : std::max(capacity * 2, required);
+    }
+};
+
+// Рост в 1,5 раза: сумма освобождённых блоков со временем превышает размер следующего,
+// и аллокатор может использовать их повторно
+struct GoldenGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        if (capacity == 0) {
+            return std::max<size_t>(required, 1);
+        }
+        const size_t step = std::max<size_t>(capacity / 2, 1);
+        return capacity > std::numeric_limits<size_t>::max() - step ? required : std::max(capacity + step, required);
+    }
+};
+
+// Округляет вместимость, выбранную политикой Base, до размерных классов: небольшие блоки
+// до степени двойки, блоки от страницы и больше до целого числа страниц PAGE_SIZE.
+// Остаток, который аллокатор сообщает через allocate_at_least, Vector использует сам
+template <typename Base = DoublingGrowth, size_t PAGE_SIZE = 4096>
+struct PageRoundedGrowth {
+    static_assert((PAGE_SIZE & (PAGE_SIZE - 1)) == 0, "Размер страницы должен быть степенью двойки");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t base = Base::NextCapacity(capacity, required, element_size);
+        if (base > (std::numeric_limits<size_t>::max() - PAGE_SIZE) / element_size) {
+            return base;
+        }
+        const size_t bytes = base * element_size;
+        size_t rounded = PAGE_SIZE;
+        if (bytes < PAGE_SIZE) {
+            while (rounded / 2 >= bytes) {
+                rounded /= 2;
+            }
+        } else {
+            rounded = (bytes + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+        }
+        return std::max(rounded / element_size, base);
+    }
+};
+
+// Удваивает вместимость, пока прирост не превысит MAX_STEP_BYTES, после чего растёт
+// линейно на MAX_STEP_BYTES. Ограничивает перерасход памяти у очень больших векторов
+template <size_t MAX_STEP_BYTES = (size_t{64} << 20)>
+struct CappedLinearGrowth {
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t max_step = std::max<size_t>(MAX_STEP_BYTES / element_size, 1);
+        const size_t step = capacity == 0 ? 1 : std::min(capacity, max_step);
+        return capacity > std::numeric_limits<size_t>::max() - step ? required : std::max(capacity + step, required);
+    }
+};
+
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
 class Vector {
 public:
     using iterator = T*;
     using const_iterator = const T*;
+    using allocator_type = Alloc;
+
+    constexpr Vector() = default;
 
-    Vector() = default;
+    constexpr explicit Vector(const Alloc& alloc) noexcept
+    : data_(alloc) {
+    }
 
-    explicit Vector(size_t size)
-    : data_(size)
+    constexpr explicit Vector(size_t size, const Alloc& alloc = Alloc())
+    : data_(size, alloc)
     , size_(size)  //
     {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+        UninitializedValueConstructN(data_.GetAddress(), size);
+    }
+
+    constexpr Vector(const Vector& other)
+    : Vector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator())) {
     }
 
-    Vector(const Vector& other)
-    : data_(other.size_)
+    constexpr Vector(const Vector& other, const Alloc& alloc)
+    : data_(other.size_, alloc)
     , size_(other.size_)
     {
-        std::uninitialized_copy_n(other.data_.GetAddress(),other.size_,data_.GetAddress());
+        UninitializedCopyN(other.data_.GetAddress(),other.size_,data_.GetAddress());
+    }
+
+    constexpr Vector(Vector&& other) noexcept
+    : data_(std::move(other.data_))
+    , size_(std::exchange(other.size_, 0))
+    {
     }
 
-    Vector(Vector&& other) noexcept
-    : data_{}
-    , size_{0}
+    constexpr Vector(Vector&& other, const Alloc& alloc)
+    : data_(alloc)
     {
-        Swap(other);
+        if (alloc == other.GetAllocator()) {
+            data_.Swap(other.data_);
+            std::swap(size_, other.size_);
+        } else {
+            // Память other принадлежит другому аллокатору, поэтому элементы перемещаются по одному
+            Memory new_data(other.size_, alloc);
+            UninitializedMoveN(other.data_.GetAddress(), other.size_, new_data.GetAddress());
+            data_.Swap(new_data);
+            size_ = other.size_;
+        }
     }
 
-    Vector& operator=(const Vector& rhs) {
+    constexpr Vector& operator=(const Vector& rhs) {
         if (this != &rhs) {
-            if (rhs.size_ > data_.Capacity()) {
-                Vector rhs_copy(rhs);
-                Swap(rhs_copy);
-            } else {
-                /* Скопировать элементы из rhs, создав при необходимости новые
-                 *                 или удалив существующие */
-                if (size_ > rhs.size_) {
-                    std::copy(rhs.data_.GetAddress(),rhs.data_.GetAddress() + rhs.size_,data_.GetAddress());
-                    std::destroy_n(data_.GetAddress()+ rhs.size_, size_ - rhs.size_);
-                } else {
-                    std::copy(rhs.data_.GetAddress(), rhs.data_.GetAddress() + size_, data_.GetAddress());
-                    std::uninitialized_copy_n(rhs.data_.GetAddress() + size_, rhs.size_ - size_,data_.GetAddress()+ size_);
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (GetAllocator() != rhs.GetAllocator()) {
+                    // Текущие элементы и память нужно вернуть старому аллокатору
+                    Vector rhs_copy(rhs, rhs.GetAllocator());
+                    DestroyN(data_.GetAddress(), size_);
+                    data_ = std::move(rhs_copy.data_);
+                    size_ = std::exchange(rhs_copy.size_, 0);
+                    return *this;
                 }
+                data_.GetAllocator() = rhs.GetAllocator();
             }
-            size_ = rhs.size_;
+            AssignN(rhs.data_.GetAddress(), rhs.size_);
         }
         return *this;
     }
 
-    Vector& operator=(Vector&& rhs) noexcept {
+    constexpr Vector& operator=(Vector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                             || AllocTraits::is_always_equal::value) {
         if (this != &rhs) {
-            Swap(rhs);
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                DestroyN(data_.GetAddress(), size_);
+                data_ = std::move(rhs.data_);
+                size_ = std::exchange(rhs.size_, 0);
+            } else if (AllocTraits::is_always_equal::value || GetAllocator() == rhs.GetAllocator()) {
+                Swap(rhs);
+            } else {
+                // Забрать память rhs нельзя: она принадлежит другому аллокатору
+                AssignN(std::make_move_iterator(rhs.data_.GetAddress()), rhs.size_);
+            }
         }
         return *this;
     }
 
-    ~Vector() {
+    constexpr ~Vector() {
         DestroyN(data_.GetAddress(),size_);
     }
 
-    iterator begin() noexcept {
+    constexpr iterator begin() noexcept {
         return data_.GetAddress();
     }
-    iterator end() noexcept {
+    constexpr iterator end() noexcept {
         return (data_.GetAddress() + size_);
     }
-    const_iterator begin() const noexcept {
+    constexpr const_iterator begin() const noexcept {
         return data_.GetAddress();
     }
-    const_iterator end() const noexcept {
+    constexpr const_iterator end() const noexcept {
         return (data_.GetAddress() + size_);
     }
-    const_iterator cbegin() const noexcept {
+    constexpr const_iterator cbegin() const noexcept {
         return begin();
     }
-    const_iterator cend() const noexcept {
+    constexpr const_iterator cend() const noexcept {
         return end();
     }
 
-    const T& operator[](size_t index) const noexcept {
+    constexpr const T& operator[](size_t index) const noexcept {
         return const_cast<Vector&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
+    constexpr T& operator[](size_t index) noexcept {
         assert(index < size_);
         return data_[index];
     }
 
-    size_t Capacity() const noexcept {
+    constexpr size_t Capacity() const noexcept {
         return data_.Capacity();
     }
 
+    constexpr const Alloc& GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    constexpr std::span<T> AsSpan() noexcept {
+        return {data_.GetAddress(), size_};
+    }
+
+    constexpr std::span<const T> AsSpan() const noexcept {
+        return {data_.GetAddress(), size_};
+    }
+
+    // Байтовое представление элементов, например для записи в сокет или файл
+    std::span<const std::byte> AsBytes() const noexcept {
+        return std::as_bytes(AsSpan());
+    }
+
+    // Принимает во владение буфер вместимостью capacity, выделенный аллокатором вектора,
+    // с size уже созданными в его начале элементами. Прежние элементы разрушаются
+    constexpr void AdoptBuffer(T* buffer, size_t size, size_t capacity) noexcept {
+        assert(size <= capacity);
+        Clear();
+        Memory adopted(buffer, capacity, GetAllocator());
+        data_.Swap(adopted);
+        size_ = size;
+    }
+
+    // Отдаёт буфер вызывающему вместе с элементами: разрушить их и освободить буфер
+    // вместимостью Capacity() аллокатором вектора должен он. Вектор становится пустым
+    constexpr T* ReleaseBuffer() noexcept {
+        size_ = 0;
+        return data_.Release();
+    }
+
+    // Копирование и присваивание вектора выполняются одним memcpy
+    static constexpr bool BITWISE_COPY = detail::ElementOps<T, Alloc>::BITWISE_COPY;
+    // Разрушение элементов ничего не делает
+    static constexpr bool TRIVIAL_DESTROY = detail::ElementOps<T, Alloc>::TRIVIAL_DESTROY;
+
+    // Гарантированное выравнивание буфера
+    static constexpr size_t ALIGNMENT = RawMemory<T, Alloc>::ALIGNMENT;
+
+    // Начало буфера с подсказкой компилятору о его выравнивании, чтобы циклы по
+    // [AssumeAligned(), AssumeAligned() + Size()) векторизовались выровненными загрузками
+    constexpr T* AssumeAligned() noexcept {
+        return std::assume_aligned<ALIGNMENT>(data_.GetAddress());
+    }
+
+    constexpr const T* AssumeAligned() const noexcept {
+        return std::assume_aligned<ALIGNMENT>(data_.GetAddress());
+    }
+
     template <typename... Args>
-    iterator Emplace(const_iterator pos, Args&&... args) {
+    constexpr iterator Emplace(const_iterator pos, Args&&... args) {
         iterator nc_pos = const_cast<iterator>(pos);
         if(size_ < Capacity()) {
-            if(pos == end()) {
-                new (end()) T(std::forward<Args>(args)...);
-                nc_pos = end();
-            } else {
-                T tmp(std::forward<Args>(args)...);
-                std::uninitialized_move_n(end()-1,1,end());
-                std::move_backward(nc_pos,end() - 1, end());
-                *nc_pos = std::move(tmp);
-            }
-            ++size_;
-            return nc_pos;
+            return EmplaceWithinCapacity(nc_pos, std::forward<Args>(args)...);
         }
 
-        size_t size = 0;
-        if(data_.Capacity() == 0) {
-            size = 1;
-        } else {
-            size = data_.Capacity() * 2;
-        }
-        RawMemory<T> new_data(size);
-        T* new_data_pos = new_data.GetAddress() + (nc_pos - data_.GetAddress());
-        new (new_data_pos) T(std::forward<Args>(args)...);
-        if(begin() != end()) {
-            try {
-                CopyOrMoveData(data_.GetAddress(), nc_pos - data_.GetAddress(), new_data.GetAddress());
-            } catch(...) {
-                new_data_pos->~T();
+        const size_t size = GrowthCapacity(size_ + 1);
+        const size_t index = nc_pos - data_.GetAddress();
+        if constexpr (CAN_GROW_IN_PLACE) {
+            // Буфер может переехать при росте, а аргументы ссылаться на его элементы,
+            // поэтому значение создаётся заранее
+            TemporaryValue tmp(data_.GetAllocator(), std::forward<Args>(args)...);
+            if (TryGrowInPlace(size)) {
+                return EmplaceWithinCapacity(data_.GetAddress() + index, std::move(tmp.Get()));
             }
+            return EmplaceReallocating(index, size, std::move(tmp.Get()));
+        } else {
+            return EmplaceReallocating(index, size, std::forward<Args>(args)...);
         }
-
-        try {
-            CopyOrMoveData(nc_pos, end() - nc_pos, new_data_pos + 1);
-        } catch(...) {
-            DestroyN(new_data.GetAddress(),new_data_pos - new_data.GetAddress());
-        }
-
-        data_.Swap(new_data);
-        DestroyN(new_data.GetAddress(), size_);
-        ++size_;
-        return new_data_pos;
     }
 
     template <typename... Args>
-    T& EmplaceBack(Args&&... args) {
+    constexpr T& EmplaceBack(Args&&... args) {
         return *Emplace(end(),std::forward<Args>(args)...);
     }
 
-    iterator Erase(const_iterator pos) {
+    constexpr iterator Erase(const_iterator pos) {
         iterator nc_pos = const_cast<iterator>(pos);
-        std::move(nc_pos+1, end(), nc_pos);
-        Destroy(end()-1);
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            Destroy(nc_pos);
+            Ops::MoveBytes(nc_pos, nc_pos + 1, end() - nc_pos - 1);
+        } else {
+            std::move(nc_pos+1, end(), nc_pos);
+            Destroy(end()-1);
+        }
         --size_;
         return nc_pos;
     }
 
-    iterator Insert(const_iterator pos, const T& value) {
+    // Удаляет элементы [first, last). Хвост сдвигается один раз
+    constexpr iterator Erase(const_iterator first, const_iterator last) {
+        iterator nc_first = const_cast<iterator>(first);
+        iterator nc_last = const_cast<iterator>(last);
+        const size_t count = nc_last - nc_first;
+        if (count == 0) {
+            return nc_first;
+        }
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            DestroyN(nc_first, count);
+            Ops::MoveBytes(nc_first, nc_last, end() - nc_last);
+        } else {
+            std::move(nc_last, end(), nc_first);
+            DestroyN(end() - count, count);
+        }
+        size_ -= count;
+        return nc_first;
+    }
+
+    // Удаляет элемент за O(1), ставя на его место последний элемент. Порядок
+    // элементов не сохраняется. Возвращает итератор на элемент, занявший место удалённого
+    constexpr iterator SwapAndPop(const_iterator pos) {
+        iterator nc_pos = const_cast<iterator>(pos);
+        iterator last = end() - 1;
+        if (nc_pos != last) {
+            if constexpr (IsTriviallyRelocatableV<T>) {
+                Destroy(nc_pos);
+                Ops::CopyBytes(nc_pos, last, 1);
+                --size_;
+                return nc_pos;
+            } else {
+                *nc_pos = std::move(*last);
+            }
+        }
+        PopBack();
+        return nc_pos;
+    }
+
+    constexpr iterator Insert(const_iterator pos, const T& value) {
         return Emplace(pos, value);
     }
-    iterator Insert(const_iterator pos, T&& value) {
+    constexpr iterator Insert(const_iterator pos, T&& value) {
         return Emplace(pos, std::move(value));
     }
 
-    void PopBack() noexcept {
+    // Вставляет count копий value. Хвост сдвигается один раз
+    constexpr iterator Insert(const_iterator pos, size_t count, const T& value) {
+        const size_t index = pos - cbegin();
+        // value может быть элементом вектора, который сдвинется или переедет
+        TemporaryValue tmp(data_.GetAllocator(), value);
+        return InsertN(index, detail::RepeatIterator<T>(tmp.Get()), count);
+    }
+
+    // Вставляет элементы диапазона [first, last), который не должен ссылаться на элементы
+    // вектора. Для однонаправленных итераторов память выделяется не более одного раза,
+    // а хвост сдвигается один раз
+    template <std::input_iterator InputIt>
+    constexpr iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        const size_t index = pos - cbegin();
+        if constexpr (std::forward_iterator<InputIt>) {
+            return InsertN(index, first, static_cast<size_t>(std::distance(first, last)));
+        } else {
+            // Длина диапазона неизвестна: элементы добавляются в конец и затем
+            // переставляются на место
+            const size_t old_size = size_;
+            try {
+                for (; first != last; ++first) {
+                    EmplaceBack(*first);
+                }
+            } catch (...) {
+                DestroyN(data_.GetAddress() + old_size, size_ - old_size);
+                size_ = old_size;
+                throw;
+            }
+            std::rotate(begin() + index, begin() + old_size, end());
+            return begin() + index;
+        }
+    }
+
+    // Добавляет в конец вектора элементы диапазона
+    template <std::ranges::input_range Range>
+    constexpr void Append(Range&& range) {
+        if constexpr (std::ranges::forward_range<Range>) {
+            InsertN(size_, std::ranges::begin(range), static_cast<size_t>(std::ranges::distance(range)));
+        } else {
+            Insert(cend(), std::ranges::begin(range), std::ranges::end(range));
+        }
+    }
+
+    // Заменяет содержимое вектора элементами диапазона [first, last), повторно
+    // используя существующие элементы и выделенную память
+    template <std::input_iterator InputIt>
+    constexpr void Assign(InputIt first, InputIt last) {
+        if constexpr (std::forward_iterator<InputIt>) {
+            AssignN(first, static_cast<size_t>(std::distance(first, last)));
+        } else {
+            DestroyN(data_.GetAddress(), size_);
+            size_ = 0;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+
+    constexpr void PopBack() noexcept {
         Destroy(end() - 1);
         --size_;
     }
 
-    void PushBack(const T& value) {
+    constexpr void PushBack(const T& value) {
         EmplaceBack(value);
     }
 
-    void PushBack(T&& value) {
+    constexpr void PushBack(T&& value) {
         EmplaceBack(std::move(value));
     }
 
-    void Reserve(size_t new_capacity) {
+    constexpr void Reserve(size_t new_capacity) {
         if (new_capacity <= data_.Capacity()) {
             return;
         }
+        if (new_capacity > MaxSize()) {
+            throw std::length_error("Vector: requested capacity exceeds MaxSize()");
+        }
+
+        if (TryGrowInPlace(new_capacity)) {
+            return;
+        }
+        ReallocateTo(new_capacity);
+    }
+
+    // Уменьшает вместимость до max(capacity, Size()), возвращая лишнюю память аллокатору.
+    // Элементы переносятся так же, как при Reserve: если перенос выбросит исключение,
+    // вектор останется прежним
+    constexpr void ShrinkTo(size_t capacity) {
+        const size_t new_capacity = std::max(capacity, size_);
+        if (new_capacity >= data_.Capacity()) {
+            return;
+        }
+        if (new_capacity == 0) {
+            Memory empty(GetAllocator());
+            data_.Swap(empty);
+        } else if constexpr (Memory::CAN_REALLOCATE && IsTriviallyRelocatableV<T>) {
+            if (std::is_constant_evaluated()) {
+                ReallocateTo(new_capacity);
+            } else {
+                data_.Reallocate(new_capacity);
+            }
+        } else {
+            ReallocateTo(new_capacity);
+        }
+    }
+
+    constexpr void ShrinkToFit() {
+        ShrinkTo(size_);
+    }
+
+    // Удаляет все элементы. При release == true освобождает и память
+    constexpr void Clear(bool release = true) noexcept {
+        DestroyN(data_.GetAddress(), size_);
+        size_ = 0;
+        if (release) {
+            Memory empty(GetAllocator());
+            data_.Swap(empty);
+        }
+    }
 
-        RawMemory<T> new_data(new_capacity);
-        CopyOrMoveData(data_.GetAddress(), size_, new_data.GetAddress());
-        new_data.Swap(data_);
-        std::destroy_n(new_data.GetAddress(), size_);
+    constexpr void Resize(size_t new_size) {
+        if(new_size < size_) {
+            DestroyN(data_.GetAddress() + new_size, size_ - new_size);
+            size_ = new_size;
+        } else if(new_size > size_) {
+            if (new_size > Capacity()) {
+                Reserve(GrowthCapacity(new_size));
+            }
+            UninitializedValueConstructN(data_.GetAddress() + size_, new_size - size_);
+            size_ = new_size;
+        }
     }
 
-    void Resize(size_t new_size) {
+    // Как Resize, но новые элементы инициализируются по умолчанию: память под элементы
+    // тривиальных типов не обнуляется. Удобно перед заполнением буфера через read()/recv()
+    constexpr void ResizeDefaultInit(size_t new_size) {
         if(new_size < size_) {
             DestroyN(data_.GetAddress() + new_size, size_ - new_size);
             size_ = new_size;
         } else if(new_size > size_) {
-            Reserve(new_size);
-            std::uninitialized_value_construct_n(data_.GetAddress() + size_, new_size - size_);
+            if (new_size > Capacity()) {
+                Reserve(GrowthCapacity(new_size));
+            }
+            UninitializedDefaultConstructN(data_.GetAddress() + size_, new_size - size_);
             size_ = new_size;
         }
     }
 
-    size_t Size() const noexcept {
+    // По образцу std::string::resize_and_overwrite: обеспечивает место под count элементов
+    // и вызывает operation(data, count). Элементы после прежнего размера не инициализированы,
+    // operation записывает их и возвращает новый размер, не больший count.
+    // Если operation выбросит исключение, размер вектора не изменится
+    template <typename Operation>
+    constexpr void ResizeAndOverwrite(size_t count, Operation operation) {
+        static_assert(std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>,
+                      "ResizeAndOverwrite доступен только для тривиальных типов");
+        if (count > Capacity()) {
+            Reserve(GrowthCapacity(count));
+        }
+        const size_t new_size = static_cast<size_t>(std::move(operation)(data_.GetAddress(), count));
+        assert(new_size <= count);
+        size_ = new_size;
+    }
+
+    constexpr size_t Size() const noexcept {
         return size_;
     }
 
-    void Swap(Vector& other) noexcept {
+    constexpr size_t MaxSize() const noexcept {
+        return std::min<size_t>(AllocTraits::max_size(data_.GetAllocator()),
+                                std::numeric_limits<std::ptrdiff_t>::max() / sizeof(T));
+    }
+
+    constexpr void Swap(Vector& other) noexcept {
         data_.Swap(other.data_);
         std::swap(size_,other.size_);
     }
 
 private:
-    RawMemory<T> data_;
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using Memory = RawMemory<T, Alloc>;
+    using Ops = detail::ElementOps<T, Alloc>;
+    using TemporaryValue = detail::TemporaryValue<T, Alloc>;
+    using Stats = detail::StatsHooks<T>;
+
+    // Вместимость можно увеличить без поэлементного переноса в новый буфер
+    static constexpr bool CAN_GROW_IN_PLACE =
+        Memory::CAN_EXPAND_IN_PLACE || (Memory::CAN_REALLOCATE && IsTriviallyRelocatableV<T>);
+
+    Memory data_;
     size_t size_ = 0;
 
-    static void DestroyN(T* buf, size_t n) noexcept {
-        for (size_t i = 0; i != n; ++i) {
-            Destroy(buf + i);
+    template <typename... Args>
+    constexpr iterator EmplaceWithinCapacity(iterator pos, Args&&... args) {
+        assert(size_ < Capacity());
+        if(pos == end()) {
+            Construct(end(), std::forward<Args>(args)...);
+        } else {
+            // Аргументы могут ссылаться на элементы вектора, поэтому значение
+            // создаётся до сдвига хвоста
+            TemporaryValue tmp(data_.GetAllocator(), std::forward<Args>(args)...);
+            if constexpr (IsTriviallyRelocatableV<T>) {
+                Ops::MoveBytes(pos + 1, pos, end() - pos);
+                tmp.RelocateTo(pos);
+            } else {
+                Construct(end(), std::move(*(end() - 1)));
+                // Созданный элемент сразу входит в вектор: если сдвиг выбросит исключение,
+                // он будет разрушен вместе с остальными
+                ++size_;
+                std::move_backward(pos, end() - 2, end() - 1);
+                *pos = std::move(tmp.Get());
+                return pos;
+            }
         }
+        ++size_;
+        return pos;
     }
 
-    void CopyOrMoveData(T* begin, size_t size, T* end) {
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(begin, size, end);
+    // Создаёт элемент в позиции index нового буфера вместимостью new_capacity
+    // и переносит в этот буфер остальные элементы
+    template <typename... Args>
+    constexpr iterator EmplaceReallocating(size_t index, size_t new_capacity, Args&&... args) {
+        Stats::OnReallocate(Capacity());
+        Memory new_data(new_capacity, GetAllocator());
+        T* new_data_pos = new_data.GetAddress() + index;
+        T* old_pos = data_.GetAddress() + index;
+        Construct(new_data_pos, std::forward<Args>(args)...);
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            Ops::CopyBytes(new_data.GetAddress(), data_.GetAddress(), index);
+            Ops::CopyBytes(new_data_pos + 1, old_pos, size_ - index);
+            data_.Swap(new_data);
+            ++size_;
+            return new_data_pos;
+        }
+
+        try {
+            CopyOrMoveData(data_.GetAddress(), index, new_data.GetAddress());
+        } catch(...) {
+            Destroy(new_data_pos);
+            throw;
+        }
+
+        try {
+            CopyOrMoveData(old_pos, size_ - index, new_data_pos + 1);
+        } catch(...) {
+            DestroyN(new_data.GetAddress(), index + 1);
+            throw;
+        }
+
+        data_.Swap(new_data);
+        DestroyN(new_data.GetAddress(), size_);
+        ++size_;
+        return new_data_pos;
+    }
+
+    // Переносит элементы в новый буфер вместимостью new_capacity. Если перенос
+    // выбросит исключение, вектор останется прежним
+    constexpr void ReallocateTo(size_t new_capacity) {
+        Stats::OnReallocate(Capacity());
+        Memory new_data(new_capacity, GetAllocator());
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            Ops::CopyBytes(new_data.GetAddress(), data_.GetAddress(), size_);
+            new_data.Swap(data_);
         } else {
-            std::uninitialized_copy_n(begin, size, end);
+            CopyOrMoveData(data_.GetAddress(), size_, new_data.GetAddress());
+            new_data.Swap(data_);
+            DestroyN(new_data.GetAddress(), size_);
         }
     }
 
-    // Создаёт копию объекта elem в сырой памяти по адресу buf
-    static void CopyConstruct(T* buf, const T& elem) {
-        new (buf) T(elem);
+    // Вставляет n элементов, начиная с first, в позицию index
+    template <typename ForwardIt>
+    constexpr iterator InsertN(size_t index, ForwardIt first, size_t n) {
+        if (n == 0) {
+            return begin() + index;
+        }
+        if (n > MaxSize() - size_) {
+            throw std::length_error("Vector: requested size exceeds MaxSize()");
+        }
+        if (size_ + n > Capacity()) {
+            const size_t new_capacity = GrowthCapacity(size_ + n);
+            if (!TryGrowInPlace(new_capacity)) {
+                return InsertReallocating(index, new_capacity, first, n);
+            }
+        }
+
+        T* pos = data_.GetAddress() + index;
+        T* old_end = end();
+        const size_t elems_after = size_ - index;
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            Ops::MoveBytes(pos + n, pos, elems_after);
+            try {
+                UninitializedCopyN(first, n, pos);
+            } catch (...) {
+                Ops::MoveBytes(pos, pos + n, elems_after);
+                throw;
+            }
+            size_ += n;
+        } else if (elems_after > n) {
+            UninitializedMoveN(old_end - n, n, old_end);
+            size_ += n;
+            std::move_backward(pos, old_end - n, old_end);
+            std::copy_n(first, n, pos);
+        } else {
+            // Часть новых элементов попадает за старый конец и создаётся в сырой памяти
+            ForwardIt mid = std::next(first, elems_after);
+            UninitializedCopyN(mid, n - elems_after, old_end);
+            try {
+                UninitializedMoveN(pos, elems_after, old_end + (n - elems_after));
+            } catch (...) {
+                DestroyN(old_end, n - elems_after);
+                throw;
+            }
+            size_ += n;
+            std::copy_n(first, elems_after, pos);
+        }
+        return pos;
     }
 
-    // Вызывает деструктор объекта по адресу buf
-    static void Destroy(T* buf) noexcept {
-        buf->~T();
+    // Создаёт n элементов в позиции index нового буфера вместимостью new_capacity
+    // и переносит в этот буфер остальные элементы
+    template <typename ForwardIt>
+    constexpr iterator InsertReallocating(size_t index, size_t new_capacity, ForwardIt first, size_t n) {
+        Stats::OnReallocate(Capacity());
+        Memory new_data(new_capacity, GetAllocator());
+        T* new_data_pos = new_data.GetAddress() + index;
+        T* old_pos = data_.GetAddress() + index;
+        UninitializedCopyN(first, n, new_data_pos);
+        if constexpr (IsTriviallyRelocatableV<T>) {
+            Ops::CopyBytes(new_data.GetAddress(), data_.GetAddress(), index);
+            Ops::CopyBytes(new_data_pos + n, old_pos, size_ - index);
+            data_.Swap(new_data);
+            size_ += n;
+            return new_data_pos;
+        }
+
+        try {
+            CopyOrMoveData(data_.GetAddress(), index, new_data.GetAddress());
+        } catch(...) {
+            DestroyN(new_data_pos, n);
+            throw;
+        }
+
+        try {
+            CopyOrMoveData(old_pos, size_ - index, new_data_pos + n);
+        } catch(...) {
+            DestroyN(new_data.GetAddress(), index + n);
+            throw;
+        }
+
+        data_.Swap(new_data);
+        DestroyN(new_data.GetAddress(), size_);
+        size_ += n;
+        return new_data_pos;
+    }
+
+    // Вместимость, до которой политика роста увеличивает буфер, чтобы в нём поместилось
+    // required элементов
+    constexpr size_t GrowthCapacity(size_t required) const {
+        if (required > MaxSize()) {
+            throw std::length_error("Vector: requested size exceeds MaxSize()");
+        }
+        const size_t capacity = std::clamp(Growth::NextCapacity(Capacity(), required, sizeof(T)), required, MaxSize());
+        Stats::OnGrowth(required, capacity);
+        return capacity;
+    }
+
+    // Увеличивает вместимость, сохраняя элементы на месте (expand_in_place) либо
+    // перевыделяя буфер целиком без поэлементного переноса (reallocate)
+    constexpr bool TryGrowInPlace(size_t new_capacity) {
+        if (std::is_constant_evaluated()) {
+            return false;
+        }
+        if (data_.TryExpandInPlace(new_capacity)) {
+            Stats::OnGrowInPlace();
+            return true;
+        }
+        if constexpr (Memory::CAN_REALLOCATE && IsTriviallyRelocatableV<T>) {
+            data_.Reallocate(new_capacity);
+            Stats::OnGrowInPlace();
+            return true;
+        }
+        return false;
+    }
+
+    // Присваивает вектору n элементов, начиная с first, повторно используя
+    // уже созданные элементы и выделенную память
+    template <typename InputIt>
+    constexpr void AssignN(InputIt first, size_t n) {
+        if (n > data_.Capacity()) {
+            Memory new_data(n, GetAllocator());
+            UninitializedCopyN(first, n, new_data.GetAddress());
+            DestroyN(data_.GetAddress(), size_);
+            data_.Swap(new_data);
+        } else {
+            Ops::AssignN(data_.GetAllocator(), data_.GetAddress(), size_, first, n);
+        }
+        size_ = n;
+    }
+
+    constexpr void DestroyN(T* buf, size_t n) noexcept {
+        Ops::DestroyN(data_.GetAllocator(), buf, n);
+    }
+
+    constexpr void CopyOrMoveData(T* begin, size_t size, T* end) {
+        Ops::CopyOrMoveData(data_.GetAllocator(), begin, size, end);
+    }
+
+    constexpr void UninitializedValueConstructN(T* buf, size_t n) {
+        Ops::UninitializedValueConstructN(data_.GetAllocator(), buf, n);
+    }
+
+    constexpr void UninitializedDefaultConstructN(T* buf, size_t n) {
+        Ops::UninitializedDefaultConstructN(data_.GetAllocator(), buf, n);
+    }
+
+    template <typename InputIt>
+    constexpr void UninitializedCopyN(InputIt first, size_t n, T* buf) {
+        Ops::UninitializedCopyN(data_.GetAllocator(), first, n, buf);
+    }
+
+    constexpr void UninitializedMoveN(T* first, size_t n, T* buf) {
+        Ops::UninitializedMoveN(data_.GetAllocator(), first, n, buf);
+    }
+
+    template <typename... Args>
+    constexpr void Construct(T* buf, Args&&... args) {
+        Ops::Construct(data_.GetAllocator(), buf, std::forward<Args>(args)...);
+    }
+
+    constexpr void Destroy(T* buf) noexcept {
+        Ops::Destroy(data_.GetAllocator(), buf);
+    }
+};
+
+// Удаляет из вектора все элементы, удовлетворяющие предикату, за один проход.
+// Возвращает число удалённых элементов
+template <typename T, typename Alloc, typename Growth, typename Predicate>
+constexpr size_t EraseIf(Vector<T, Alloc, Growth>& vector, Predicate predicate) {
+    auto first_removed = std::remove_if(vector.begin(), vector.end(), std::move(predicate));
+    const size_t count = vector.end() - first_removed;
+    vector.Erase(first_removed, vector.end());
+    return count;
+}
+
+// Векторы равны, если равны их размеры и элементы. Элементы целочисленных типов,
+// перечислений и указателей сравниваются через memcmp
+template <typename T, typename Alloc, typename Growth>
+constexpr bool operator==(const Vector<T, Alloc, Growth>& lhs, const Vector<T, Alloc, Growth>& rhs) {
+    if (lhs.Size() != rhs.Size()) {
+        return false;
+    }
+    if constexpr (detail::IS_BITWISE_COMPARABLE<T>) {
+        if (!std::is_constant_evaluated()) {
+            return lhs.Size() == 0 || std::memcmp(lhs.begin(), rhs.begin(), lhs.Size() * sizeof(T)) == 0;
+        }
+    }
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+// Лексикографическое сравнение. Байты без знака сравниваются через memcmp
+template <typename T, typename Alloc, typename Growth>
+    requires std::three_way_comparable<T>
+constexpr std::compare_three_way_result_t<T> operator<=>(const Vector<T, Alloc, Growth>& lhs,
+                                                         const Vector<T, Alloc, Growth>& rhs) {
+    if constexpr (detail::IS_UNSIGNED_BYTE<T>) {
+        if (!std::is_constant_evaluated()) {
+            const size_t common = std::min(lhs.Size(), rhs.Size());
+            if (const int result = common == 0 ? 0 : std::memcmp(lhs.begin(), rhs.begin(), common)) {
+                return result <=> 0;
+            }
+            return lhs.Size() <=> rhs.Size();
+        }
+    }
+    return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+namespace pmr {
+
+// Vector, память которого выделяется из std::pmr::memory_resource.
+// Ресурс задаётся при создании вектора и не входит в его тип
+template <typename T, typename Growth = DoublingGrowth>
+using Vector = ::Vector<T, std::pmr::polymorphic_allocator<T>, Growth>;
+
+}  // namespace pmr
+
+// Хеш вектора согласован с operator==: элементы, равенство которых равносильно
+// равенству байтов, хешируются одним проходом по байтам буфера, остальные
+// поэлементно через std::hash<T>
+template <typename T, typename Alloc, typename Growth>
+    requires detail::IS_BITWISE_COMPARABLE<T> || requires(const T& value) { std::hash<T>{}(value); }
+struct std::hash<Vector<T, Alloc, Growth>> {
+    size_t operator()(const Vector<T, Alloc, Growth>& vector) const noexcept {
+        if constexpr (detail::IS_BITWISE_COMPARABLE<T>) {
+            return static_cast<size_t>(detail::HashBytes(vector.begin(), vector.Size() * sizeof(T)));
+        } else {
+            uint64_t hash = detail::HashMix(vector.Size(), 0x9e3779b97f4a7c15);
+            for (const T& value : vector) {
+                hash = detail::HashMix(hash ^ std::hash<T>{}(value), 0x9e3779b97f4a7c15);
+            }
+            return static_cast<size_t>(hash);
+        }
     }
 };
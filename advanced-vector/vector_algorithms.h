@@ -0,0 +1,309 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+#include <ranges>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define VECTOR_HAS_AVX2_KERNELS 1
+#else
+#define VECTOR_HAS_AVX2_KERNELS 0
+#endif
+
+// Алгоритмы над непрерывными диапазонами (Vector, SmallVector, std::vector, массивы).
+// Для int32_t и float поиск, подсчёт, минимум, максимум и сумма выполняются ядрами AVX2,
+// если процессор их поддерживает; выбор делается во время выполнения. Ядра читают память
+// невыровненными загрузками, поэтому особого выравнивания буфера не требуют.
+// Для остальных типов и на других процессорах используются обычные циклы
+
+namespace detail::simd {
+
+// Сумма целых накапливается в 64-битном типе, сумма остальных типов в самом T
+template <typename T>
+using SumType = std::conditional_t<!std::is_integral_v<T>, T,
+                                   std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+template <typename T>
+inline constexpr bool HAS_KERNELS =
+    VECTOR_HAS_AVX2_KERNELS && (std::is_same_v<T, int32_t> || std::is_same_v<T, float>);
+
+#if VECTOR_HAS_AVX2_KERNELS
+
+inline bool HasAvx2() noexcept {
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+}
+
+// Восемь элементов T в регистре AVX2 и операции над ними
+template <typename T>
+struct Lanes;
+
+template <>
+struct Lanes<int32_t> {
+    using Reg = __m256i;
+
+    [[gnu::target("avx2")]] static Reg Load(const int32_t* p) noexcept {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+    [[gnu::target("avx2")]] static Reg Broadcast(int32_t value) noexcept {
+        return _mm256_set1_epi32(value);
+    }
+    // Маска из восьми битов: бит i установлен, если элементы i равны
+    [[gnu::target("avx2")]] static unsigned EqualMask(Reg a, Reg b) noexcept {
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(a, b))));
+    }
+    [[gnu::target("avx2")]] static Reg Min(Reg a, Reg b) noexcept {
+        return _mm256_min_epi32(a, b);
+    }
+    [[gnu::target("avx2")]] static Reg Max(Reg a, Reg b) noexcept {
+        return _mm256_max_epi32(a, b);
+    }
+    [[gnu::target("avx2")]] static void Store(int32_t* p, Reg reg) noexcept {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), reg);
+    }
+};
+
+template <>
+struct Lanes<float> {
+    using Reg = __m256;
+
+    [[gnu::target("avx2")]] static Reg Load(const float* p) noexcept {
+        return _mm256_loadu_ps(p);
+    }
+    [[gnu::target("avx2")]] static Reg Broadcast(float value) noexcept {
+        return _mm256_set1_ps(value);
+    }
+    [[gnu::target("avx2")]] static unsigned EqualMask(Reg a, Reg b) noexcept {
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ)));
+    }
+    [[gnu::target("avx2")]] static Reg Min(Reg a, Reg b) noexcept {
+        return _mm256_min_ps(a, b);
+    }
+    [[gnu::target("avx2")]] static Reg Max(Reg a, Reg b) noexcept {
+        return _mm256_max_ps(a, b);
+    }
+    [[gnu::target("avx2")]] static void Store(float* p, Reg reg) noexcept {
+        _mm256_storeu_ps(p, reg);
+    }
+};
+
+inline constexpr size_t LANES = 8;
+
+template <typename T>
+[[gnu::target("avx2")]] const T* FindAvx2(const T* first, size_t n, T value) noexcept {
+    using L = Lanes<T>;
+    const auto needle = L::Broadcast(value);
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        if (const unsigned mask = L::EqualMask(L::Load(first + i), needle)) {
+            return first + i + __builtin_ctz(mask);
+        }
+    }
+    for (; i != n; ++i) {
+        if (first[i] == value) {
+            return first + i;
+        }
+    }
+    return first + n;
+}
+
+template <typename T>
+[[gnu::target("avx2")]] size_t CountAvx2(const T* first, size_t n, T value) noexcept {
+    using L = Lanes<T>;
+    const auto needle = L::Broadcast(value);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        count += __builtin_popcount(L::EqualMask(L::Load(first + i), needle));
+    }
+    for (; i != n; ++i) {
+        count += first[i] == value;
+    }
+    return count;
+}
+
+// Минимум (IS_MIN) или максимум непустого диапазона
+template <bool IS_MIN, typename T>
+[[gnu::target("avx2")]] T ExtremumAvx2(const T* first, size_t n) noexcept {
+    using L = Lanes<T>;
+    const auto pick = [](T a, T b) {
+        return IS_MIN ? (b < a ? b : a) : (a < b ? b : a);
+    };
+    T result = first[0];
+    size_t i = 0;
+    if (n >= LANES) {
+        auto acc = L::Load(first);
+        for (i = LANES; i + LANES <= n; i += LANES) {
+            acc = IS_MIN ? L::Min(acc, L::Load(first + i)) : L::Max(acc, L::Load(first + i));
+        }
+        T lanes[LANES];
+        L::Store(lanes, acc);
+        for (T lane : lanes) {
+            result = pick(result, lane);
+        }
+    }
+    for (; i != n; ++i) {
+        result = pick(result, first[i]);
+    }
+    return result;
+}
+
+[[gnu::target("avx2")]] inline int64_t SumAvx2(const int32_t* first, size_t n) noexcept {
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        const __m256i v = Lanes<int32_t>::Load(first + i);
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    int64_t sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i != n; ++i) {
+        sum += first[i];
+    }
+    return sum;
+}
+
+[[gnu::target("avx2")]] inline float SumAvx2(const float* first, size_t n) noexcept {
+    // Четыре независимых накопителя скрывают задержку сложения
+    __m256 acc[4] = {_mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps()};
+    size_t i = 0;
+    for (; i + 4 * LANES <= n; i += 4 * LANES) {
+        for (size_t k = 0; k != 4; ++k) {
+            acc[k] = _mm256_add_ps(acc[k], _mm256_loadu_ps(first + i + k * LANES));
+        }
+    }
+    for (; i + LANES <= n; i += LANES) {
+        acc[0] = _mm256_add_ps(acc[0], _mm256_loadu_ps(first + i));
+    }
+    float lanes[LANES];
+    _mm256_storeu_ps(lanes, _mm256_add_ps(_mm256_add_ps(acc[0], acc[1]), _mm256_add_ps(acc[2], acc[3])));
+    float sum = 0;
+    for (float lane : lanes) {
+        sum += lane;
+    }
+    for (; i != n; ++i) {
+        sum += first[i];
+    }
+    return sum;
+}
+
+#endif  // VECTOR_HAS_AVX2_KERNELS
+
+// Ядро, подходящее текущему процессору, иначе обычный цикл
+
+template <typename T>
+const T* Find(const T* first, size_t n, const T& value) {
+#if VECTOR_HAS_AVX2_KERNELS
+    if constexpr (HAS_KERNELS<T>) {
+        if (HasAvx2()) {
+            return FindAvx2(first, n, value);
+        }
+    }
+#endif
+    return std::find(first, first + n, value);
+}
+
+template <typename T>
+size_t Count(const T* first, size_t n, const T& value) {
+#if VECTOR_HAS_AVX2_KERNELS
+    if constexpr (HAS_KERNELS<T>) {
+        if (HasAvx2()) {
+            return CountAvx2(first, n, value);
+        }
+    }
+#endif
+    return static_cast<size_t>(std::count(first, first + n, value));
+}
+
+template <bool IS_MIN, typename T>
+T Extremum(const T* first, size_t n) {
+    assert(n != 0);
+#if VECTOR_HAS_AVX2_KERNELS
+    if constexpr (HAS_KERNELS<T>) {
+        if (HasAvx2()) {
+            return ExtremumAvx2<IS_MIN>(first, n);
+        }
+    }
+#endif
+    return IS_MIN ? *std::min_element(first, first + n) : *std::max_element(first, first + n);
+}
+
+template <typename T>
+SumType<T> Sum(const T* first, size_t n) {
+#if VECTOR_HAS_AVX2_KERNELS
+    if constexpr (HAS_KERNELS<T>) {
+        if (HasAvx2()) {
+            return SumAvx2(first, n);
+        }
+    }
+#endif
+    return std::accumulate(first, first + n, SumType<T>{});
+}
+
+}  // namespace detail::simd
+
+// Указатель на первый элемент, равный value, либо на конец диапазона
+template <std::ranges::contiguous_range Range>
+auto Find(Range&& range, const std::ranges::range_value_t<Range>& value) {
+    auto* first = std::ranges::data(range);
+    const auto* found = detail::simd::Find<std::ranges::range_value_t<Range>>(first, std::ranges::size(range), value);
+    return first + (found - first);
+}
+
+// Число элементов, равных value
+template <std::ranges::contiguous_range Range>
+size_t Count(const Range& range, const std::ranges::range_value_t<Range>& value) {
+    return detail::simd::Count(std::ranges::data(range), std::ranges::size(range), value);
+}
+
+// Присваивает всем элементам значение value
+template <std::ranges::contiguous_range Range>
+void Fill(Range&& range, const std::ranges::range_value_t<Range>& value) {
+    // std::fill_n для арифметических типов компилятор сам превращает в memset или векторный цикл
+    std::fill_n(std::ranges::data(range), std::ranges::size(range), value);
+}
+
+// Диапазоны равны поэлементно. Целые сравниваются через memcmp
+template <std::ranges::contiguous_range Lhs, std::ranges::contiguous_range Rhs>
+bool Equal(const Lhs& lhs, const Rhs& rhs) {
+    using T = std::ranges::range_value_t<Lhs>;
+    const size_t n = std::ranges::size(lhs);
+    if (n != std::ranges::size(rhs)) {
+        return false;
+    }
+    if constexpr ((std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>)
+                  && std::is_same_v<T, std::ranges::range_value_t<Rhs>>) {
+        return n == 0 || std::memcmp(std::ranges::data(lhs), std::ranges::data(rhs), n * sizeof(T)) == 0;
+    } else {
+        return std::equal(std::ranges::data(lhs), std::ranges::data(lhs) + n, std::ranges::data(rhs));
+    }
+}
+
+// Наименьший и наибольший элементы непустого диапазона. Если среди чисел с плавающей
+// точкой есть NaN, результат не определён
+template <std::ranges::contiguous_range Range>
+std::ranges::range_value_t<Range> Min(const Range& range) {
+    return detail::simd::Extremum<true>(std::ranges::data(range), std::ranges::size(range));
+}
+
+template <std::ranges::contiguous_range Range>
+std::ranges::range_value_t<Range> Max(const Range& range) {
+    return detail::simd::Extremum<false>(std::ranges::data(range), std::ranges::size(range));
+}
+
+// Сумма элементов. Целые суммируются в 64-битном типе. Для чисел с плавающей точкой
+// порядок сложения не определён, и результат может отличаться от последовательного
+// в пределах погрешности округления
+template <std::ranges::contiguous_range Range>
+auto Sum(const Range& range) {
+    return detail::simd::Sum(std::ranges::data(range), std::ranges::size(range));
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include "vector.h"
+
+#include <bit>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Двоичный формат непрерывных диапазонов тривиально копируемых элементов: заголовок
+// фиксированного размера, за которым без изменений следуют байты элементов.
+// Порядок байтов не преобразуется: читатель с другим порядком байтов, размером
+// или выравниванием элементов получает std::invalid_argument
+
+namespace detail {
+
+struct SerializedHeader {
+    // Сигнатура и версия формата
+    static constexpr uint32_t MAGIC = 0x5645'4331;
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint8_t LITTLE_ENDIAN_ORDER = 1;
+    static constexpr uint8_t BIG_ENDIAN_ORDER = 2;
+
+    uint32_t magic;
+    uint16_t version;
+    uint8_t endianness;
+    uint8_t reserved0;
+    uint32_t element_size;
+    uint32_t alignment;
+    uint64_t size;
+    // Дополняет заголовок до 32 байтов, чтобы элементы за ним были выровнены
+    uint64_t reserved1;
+
+    template <typename T>
+    static SerializedHeader For(size_t size) noexcept {
+        return {MAGIC, VERSION, NativeEndianness(), 0, sizeof(T), alignof(T), size, 0};
+    }
+
+    // Проверяет, что заголовок описывает элементы T, и возвращает их число
+    template <typename T>
+    size_t Check() const {
+        if (magic != MAGIC || version != VERSION) {
+            throw std::invalid_argument("Vector: data is not a serialized vector");
+        }
+        if (endianness != NativeEndianness()) {
+            throw std::invalid_argument("Vector: byte order mismatch");
+        }
+        if (element_size != sizeof(T) || alignment != alignof(T)) {
+            throw std::invalid_argument("Vector: element layout mismatch");
+        }
+        if (size > std::numeric_limits<std::ptrdiff_t>::max() / sizeof(T)) {
+            throw std::invalid_argument("Vector: serialized size is too large");
+        }
+        return static_cast<size_t>(size);
+    }
+
+    static constexpr uint8_t NativeEndianness() noexcept {
+        return std::endian::native == std::endian::little ? LITTLE_ENDIAN_ORDER : BIG_ENDIAN_ORDER;
+    }
+};
+
+static_assert(sizeof(SerializedHeader) == 32 && std::is_trivially_copyable_v<SerializedHeader>);
+
+[[noreturn]] inline void ThrowIoError(const char* operation) {
+    throw std::system_error(errno, std::generic_category(), std::string("Vector: ") + operation);
+}
+
+// Записывает все буферы iov, повторяя writev после частичной записи
+inline void WriteAll(int fd, iovec* iov, int count) {
+    while (count != 0) {
+        const ssize_t written = ::writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowIoError("writev");
+        }
+        size_t rest = static_cast<size_t>(written);
+        while (count != 0 && rest >= iov->iov_len) {
+            rest -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count != 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + rest;
+            iov->iov_len -= rest;
+        }
+    }
+}
+
+// Читает ровно bytes байтов. Конец данных раньше времени считается ошибкой
+inline void ReadAll(int fd, void* buffer, size_t bytes) {
+    auto* p = static_cast<char*>(buffer);
+    while (bytes != 0) {
+        const ssize_t got = ::read(fd, p, bytes);
+        if (got < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowIoError("read");
+        }
+        if (got == 0) {
+            throw std::runtime_error("Vector: unexpected end of serialized data");
+        }
+        p += got;
+        bytes -= static_cast<size_t>(got);
+    }
+}
+
+// Сколько байтов элементов читается до первого увеличения буфера, если размер данных
+// нельзя узнать заранее
+inline constexpr size_t DESERIALIZE_CHUNK_BYTES = size_t{1} << 20;
+
+// Сколько элементов можно выделить до чтения, не доверяя заголовку. В обычном файле
+// должно оставаться не меньше size элементов, иначе данные обрезаны. Из каналов и
+// сокетов буфер читается порциями и растёт по мере поступления данных
+template <typename T>
+size_t InitialReadCapacity(int fd, size_t size) {
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        const off_t offset = ::lseek(fd, 0, SEEK_CUR);
+        if (offset >= 0) {
+            if (info.st_size < offset || static_cast<uint64_t>(info.st_size - offset) / sizeof(T) < size) {
+                throw std::runtime_error("Vector: unexpected end of serialized data");
+            }
+            return size;
+        }
+    }
+    return std::min(size, std::max<size_t>(DESERIALIZE_CHUNK_BYTES / sizeof(T), 1));
+}
+
+// Читает size элементов в буфер, выделенный аллокатором alloc. Буфер удваивается, только
+// когда предыдущий заполнен прочитанными данными
+template <typename T, typename Alloc>
+RawMemory<T, Alloc> ReadElements(int fd, size_t size, const Alloc& alloc) {
+    RawMemory<T, Alloc> buffer(InitialReadCapacity<T>(fd, size), alloc);
+    size_t done = 0;
+    while (true) {
+        const size_t target = std::min(size, buffer.Capacity());
+        ReadAll(fd, buffer.GetAddress() + done, (target - done) * sizeof(T));
+        done = target;
+        if (done == size) {
+            return buffer;
+        }
+        RawMemory<T, Alloc> larger(std::min(size, buffer.Capacity() * 2), alloc);
+        std::memcpy(larger.GetAddress(), buffer.GetAddress(), done * sizeof(T));
+        buffer.Swap(larger);
+    }
+}
+
+}  // namespace detail
+
+inline constexpr size_t SERIALIZED_HEADER_SIZE = sizeof(detail::SerializedHeader);
+
+// Записывает в файловый дескриптор fd заголовок и байты элементов одним writev,
+// не копируя элементы в промежуточный буфер
+template <std::ranges::contiguous_range Range>
+void Serialize(int fd, const Range& range) {
+    using T = std::ranges::range_value_t<Range>;
+    static_assert(std::is_trivially_copyable_v<T>, "Сериализуются только тривиально копируемые типы");
+    const auto bytes = std::as_bytes(std::span(std::ranges::data(range), std::ranges::size(range)));
+    detail::SerializedHeader header = detail::SerializedHeader::For<T>(std::ranges::size(range));
+    iovec iov[2] = {
+        {&header, sizeof(header)},
+        {const_cast<std::byte*>(bytes.data()), bytes.size()},
+    };
+    detail::WriteAll(fd, iov, bytes.empty() ? 1 : 2);
+}
+
+// Читает из fd вектор, записанный Serialize. Байты элементов читаются сразу в буфер,
+// выделенный аллокатором alloc, который затем передаётся вектору без копирования.
+// Размер из заголовка не считается достоверным: память выделяется не больше, чем
+// осталось в файле, а при чтении из канала растёт по мере поступления данных
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+Vector<T, Alloc, Growth> Deserialize(int fd, const Alloc& alloc = Alloc()) {
+    static_assert(std::is_trivially_copyable_v<T>, "Сериализуются только тривиально копируемые типы");
+    detail::SerializedHeader header;
+    detail::ReadAll(fd, &header, sizeof(header));
+    const size_t size = header.Check<T>();
+
+    Vector<T, Alloc, Growth> result(alloc);
+    if (size != 0) {
+        RawMemory<T, Alloc> buffer = detail::ReadElements<T>(fd, size, alloc);
+        const size_t capacity = buffer.Capacity();
+        result.AdoptBuffer(buffer.Release(), size, capacity);
+    }
+    return result;
+}
+
+// Элементы, записанные Serialize в буфер bytes, без копирования. Буфер должен
+// оставаться живым, пока используется результат, и быть выровненным под T
+template <typename T>
+std::span<const T> ViewSerialized(std::span<const std::byte> bytes) {
+    static_assert(std::is_trivially_copyable_v<T>, "Сериализуются только тривиально копируемые типы");
+    if (bytes.size() < SERIALIZED_HEADER_SIZE) {
+        throw std::invalid_argument("Vector: data is not a serialized vector");
+    }
+    detail::SerializedHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    const size_t size = header.Check<T>();
+    const std::byte* data = bytes.data() + SERIALIZED_HEADER_SIZE;
+    if (bytes.size() - SERIALIZED_HEADER_SIZE < size * sizeof(T)) {
+        throw std::invalid_argument("Vector: serialized data is truncated");
+    }
+    if (reinterpret_cast<uintptr_t>(data) % alignof(T) != 0) {
+        throw std::invalid_argument("Vector: serialized data is misaligned");
+    }
+    return {reinterpret_cast<const T*>(data), size};
+}
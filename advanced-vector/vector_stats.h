@@ -0,0 +1,210 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
+
+// Инструментирование RawMemory и Vector включается макросом VECTOR_ENABLE_STATS, который
+// должен быть одинаково задан во всех единицах трансляции. Без него все точки сбора
+// статистики пусты и исчезают при компиляции
+#ifdef VECTOR_ENABLE_STATS
+inline constexpr bool VECTOR_STATS_ENABLED = true;
+#else
+inline constexpr bool VECTOR_STATS_ENABLED = false;
+#endif
+
+// Счётчики поведения векторов одного типа элементов (или одного тега)
+struct VectorStats {
+    // Выделения и освобождения памяти в RawMemory
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> deallocations{0};
+    // Переносы элементов в новый буфер и увеличения вместимости без переноса
+    std::atomic<uint64_t> reallocations{0};
+    std::atomic<uint64_t> in_place_growths{0};
+    // Байты, перенесённые конструктором перемещения, конструктором копирования
+    // (ветви CopyOrMoveData) и побайтово
+    std::atomic<uint64_t> bytes_moved{0};
+    std::atomic<uint64_t> bytes_copied{0};
+    std::atomic<uint64_t> bytes_relocated{0};
+    // Память, выделенная политикой роста сверх необходимого
+    std::atomic<uint64_t> wasted_capacity_bytes{0};
+    // Память, выделенная живыми буферами сейчас, и её максимум
+    std::atomic<uint64_t> capacity_bytes{0};
+    std::atomic<uint64_t> peak_capacity_bytes{0};
+
+    void Reset() noexcept {
+        for (std::atomic<uint64_t>* counter :
+             {&allocations, &deallocations, &reallocations, &in_place_growths, &bytes_moved, &bytes_copied,
+              &bytes_relocated, &wasted_capacity_bytes, &capacity_bytes, &peak_capacity_bytes}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+};
+
+// Тег, под которым собирается статистика векторов с элементами T. Специализация
+// позволяет объединить несколько типов под одним тегом
+template <typename T>
+struct VectorStatsTag {
+    using type = T;
+};
+
+// Реестр счётчиков всех тегов, которые встречались в программе. Регистрация происходит
+// при первом обращении к счётчикам тега из точек сбора статистики, которые не выбрасывают
+// исключений, поэтому реестр не выделяет память и не захватывает мьютекс: записи
+// хранятся в самих тегах и связаны в список, пополняемый атомарно
+class VectorStatsRegistry {
+public:
+    struct Entry {
+        std::string_view name;
+        VectorStats* stats = nullptr;
+        Entry* next = nullptr;
+    };
+
+    static VectorStatsRegistry& Instance() noexcept {
+        static VectorStatsRegistry registry;
+        return registry;
+    }
+
+    // Запись должна жить до конца программы
+    void Register(Entry* entry) noexcept {
+        Entry* head = head_.load(std::memory_order_relaxed);
+        do {
+            entry->next = head;
+        } while (!head_.compare_exchange_weak(head, entry, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Вызывает callback(std::string_view name, const VectorStats& stats) для каждого тега,
+    // например, чтобы выгрузить счётчики в систему метрик. Теги обходятся от последнего
+    // зарегистрированного к первому
+    template <typename Callback>
+    void ForEach(Callback&& callback) const {
+        for (const Entry* entry = head_.load(std::memory_order_acquire); entry != nullptr; entry = entry->next) {
+            callback(entry->name, *entry->stats);
+        }
+    }
+
+private:
+    std::atomic<Entry*> head_{nullptr};
+};
+
+// Счётчики тега Tag
+template <typename Tag>
+VectorStats& GetVectorStats() noexcept {
+    static VectorStats* const stats = [] {
+        static VectorStats instance;
+        static VectorStatsRegistry::Entry entry{typeid(Tag).name(), &instance};
+        VectorStatsRegistry::Instance().Register(&entry);
+        return &instance;
+    }();
+    return *stats;
+}
+
+namespace detail {
+
+// Точки сбора статистики для векторов с элементами T. При вычислении константных
+// выражений статистика не собирается
+template <typename T>
+struct StatsHooks {
+    static constexpr void OnAllocate(size_t count) noexcept {
+        if constexpr (VECTOR_STATS_ENABLED) {
+            if (!std::is_constant_evaluated()) {
+                VectorStats& stats = Get();
+                stats.allocations.fetch_add(1, std::memory_order_relaxed);
+                AddCapacity(stats, count);
+            }
+        }
+    }
+
+    static constexpr void OnDeallocate(size_t count) noexcept {
+        if constexpr (VECTOR_STATS_ENABLED) {
+            if (!std::is_constant_evaluated()) {
+                VectorStats& stats = Get();
+                stats.deallocations.fetch_add(1, std::memory_order_relaxed);
+                stats.capacity_bytes.fetch_sub(count * sizeof(T), std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Вместимость буфера изменилась без нового выделения (expand_in_place, reallocate)
+    static constexpr void OnResizeBuffer(size_t old_count, size_t new_count) noexcept {
+        if constexpr (VECTOR_STATS_ENABLED) {
+            if (!std::is_constant_evaluated()) {
+                VectorStats& stats = Get();
+                stats.capacity_bytes.fetch_sub(old_count * sizeof(T), std::memory_order_relaxed);
+                AddCapacity(stats, new_count);
+            }
+        }
+    }
+
+    // Элементы переезжают из буфера вместимостью old_capacity в новый.
+    // Первое выделение памяти переездом не считается
+    static constexpr void OnReallocate(size_t old_capacity) noexcept {
+        if constexpr (VECTOR_STATS_ENABLED) {
+            if (!std::is_constant_evaluated()) {
+                if (old_capacity != 0) {
+                    Get().reallocations.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        }
+    }
+
+    static constexpr void OnGrowInPlace() noexcept {
+        if constexpr (VECTOR_STATS_ENABLED) {
+            if (!std::is_constant_evaluated()) {
+                Get().in_place_growths.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static constexpr void OnMove(size_t count) noexcept {
+        if constexpr (VECTOR_STATS_ENABLED) {
+            if (!std::is_constant_evaluated()) {
+                Get().bytes_moved.fetch_add(count * sizeof(T), std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static constexpr void OnCopy(size_t count) noexcept {
+        if constexpr (VECTOR_STATS_ENABLED) {
+            if (!std::is_constant_evaluated()) {
+                Get().bytes_copied.fetch_add(count * sizeof(T), std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static constexpr void OnRelocate(size_t count) noexcept {
+        if constexpr (VECTOR_STATS_ENABLED) {
+            if (!std::is_constant_evaluated()) {
+                Get().bytes_relocated.fetch_add(count * sizeof(T), std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Политика роста выбрала вместимость capacity при необходимой required
+    static constexpr void OnGrowth(size_t required, size_t capacity) noexcept {
+        if constexpr (VECTOR_STATS_ENABLED) {
+            if (!std::is_constant_evaluated()) {
+                Get().wasted_capacity_bytes.fetch_add((capacity - required) * sizeof(T), std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    static VectorStats& Get() noexcept {
+        return GetVectorStats<typename VectorStatsTag<T>::type>();
+    }
+
+    static void AddCapacity(VectorStats& stats, size_t count) noexcept {
+        const uint64_t current =
+            stats.capacity_bytes.fetch_add(count * sizeof(T), std::memory_order_relaxed) + count * sizeof(T);
+        uint64_t peak = stats.peak_capacity_bytes.load(std::memory_order_relaxed);
+        while (peak < current
+               && !stats.peak_capacity_bytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+}  // namespace detail